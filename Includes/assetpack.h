@@ -0,0 +1,103 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <mappedfile.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//every file the program reads at startup (shaders, images, baked textures) in one file made by
+//packassets (tools/packassets.cpp): a fixed header, a table of contents sorted by the hash of each
+//file's path, the paths & then the files themselves, each 4 KiB aligned so they start on a page,
+//a file is either stored as it is or lz compressed (see lzblock.h) when that saved enough,
+//the whole pack is mapped once & the loaders get spans straight into the mapping
+
+//"GLXPACK" & the version
+static const char assetPackIdentifier[8] = { 'G', 'L', 'X', 'P', 'A', 'C', 'K', 1 };
+//blob alignment, a page
+static const size_t assetPackAlignment = 4096;
+//the blob is lz compressed, size is what it unpacks to
+static const uint32_t ASSET_COMPRESSED = 1;
+
+struct AssetPackHeader
+{
+	char identifier[8];
+	uint32_t entryCount;
+	uint32_t flags;
+	uint64_t namesOffset; // the paths, one after the other with no terminators
+	uint64_t namesSize;
+};
+static_assert(sizeof(AssetPackHeader) == 32, "the header is read straight out of the file");
+
+struct AssetPackEntry
+{
+	uint64_t hash; // fnv-1a of the path, what the table is sorted by
+	uint64_t offset; // from the start of the file
+	uint64_t storedSize; // the bytes in the pack
+	uint64_t size; // the bytes once unpacked (storedSize unless compressed)
+	uint32_t nameOffset; // into the paths
+	uint32_t nameLength;
+	uint32_t flags;
+	uint32_t reserved;
+};
+static_assert(sizeof(AssetPackEntry) == 48, "the table is read straight out of the file");
+
+//one file's bytes, pointing into the pack's mapping (owned is only used for a compressed file,
+//which gets unpacked into it), stays valid while the pack is open
+struct AssetSpan
+{
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+	std::vector<unsigned char> owned;
+};
+
+//a pack mapped read only, the lookups don't change anything so any thread can use it at once
+class AssetPack
+{
+public:
+	//maps & checks the pack (header, table & every blob inside it), paths are looked up relative to root,
+	//prints why when it isn't a good pack
+	bool open(const std::string& path, const std::string& root);
+	void close();
+	bool isOpen() const { return file.isOpen(); }
+
+	//whether path (absolute or relative to the root) is in the pack
+	bool contains(const std::string& path) const;
+	//the file's bytes, false when it isn't in the pack (or is & won't unpack)
+	bool load(const std::string& path, AssetSpan& span) const;
+
+	size_t count() const { return entryCount; }
+	//every path in the pack, in table order
+	std::vector<std::string> paths() const;
+
+private:
+	MappedFile file;
+	std::string rootPath;
+	const AssetPackEntry* entries = nullptr;
+	size_t entryCount = 0;
+	const char* names = nullptr;
+
+	//path as the pack stores it, '/' separated & relative to the root
+	std::string name(const std::string& path) const;
+	const AssetPackEntry* find(const std::string& path) const;
+};
+
+//a file going into a pack, data is what it holds, compress lets the writer try lz on it
+struct AssetPackInput
+{
+	std::string name;
+	std::vector<unsigned char> data;
+	bool compress = false;
+};
+
+//writes a pack, names are the paths relative to the root the reader will use, a compressed file is
+//only kept compressed when that's at least an eighth smaller
+bool writeAssetPack(const std::string& path, const std::vector<AssetPackInput>& files);
+
+//the process wide pack every loader looks in before going to the file itself, not open unless
+//the program opened one (see --pack)
+extern AssetPack assetPack;
+
+#endif // !ASSETPACK_H
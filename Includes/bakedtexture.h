@@ -0,0 +1,80 @@
+#ifndef BAKEDTEXTURE_H
+#define BAKEDTEXTURE_H
+
+#include <bcencoder.h>
+#include <mappedfile.h>
+#include <assetpack.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//a texture baked offline by texturebake (tools/texturebake.cpp) into a block compressed format with
+//its whole mip chain, laid out like ktx2: a fixed header, an index of every level (largest first) &
+//the level data after it (smallest first, each level 16 byte aligned) so the gpu gets uploaded
+//straight out of the file mapping with nothing decoded
+
+//"GLXBAKE" & the version
+static const char bakedTextureIdentifier[8] = { 'G', 'L', 'X', 'B', 'A', 'K', 'E', 1 };
+//the rows were flipped at bake time so the first one is the bottom of the image (gl's origin)
+static const uint32_t BAKED_FLIPPED = 1;
+
+struct BakedTextureHeader
+{
+	char identifier[8];
+	uint32_t format; // BlockFormat
+	uint32_t width;
+	uint32_t height;
+	uint32_t levelCount;
+	uint32_t flags;
+	uint32_t reserved;
+};
+static_assert(sizeof(BakedTextureHeader) == 32, "the header is read straight out of the file");
+
+struct BakedLevelIndex
+{
+	uint64_t offset; // from the start of the file
+	uint64_t size;
+};
+
+//one mip of the chain, data points into whatever holds the file
+struct BakedLevel
+{
+	int width = 0;
+	int height = 0;
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+};
+
+//a baked file mapped read only (or found in the asset pack), the levels point into the mapping
+class BakedTexture
+{
+public:
+	//maps & checks the file (header, every level inside it & the right size), prints why when it isn't
+	bool open(const std::string& path);
+	//touches every page the levels are on so the copy at upload doesn't fault them in on the gl thread
+	void prefetch() const;
+
+	BlockFormat format() const { return (BlockFormat)header.format; }
+	int width() const { return (int)header.width; }
+	int height() const { return (int)header.height; }
+	uint32_t flags() const { return header.flags; }
+	const std::vector<BakedLevel>& levels() const { return levelViews; }
+
+	//the gl internal format of a block format
+	static unsigned int glFormat(BlockFormat format);
+	//reads just the header of a baked file, false when it isn't one
+	static bool peekFormat(const std::string& path, BlockFormat& format);
+
+private:
+	MappedFile file;
+	AssetSpan packed;
+	BakedTextureHeader header = {};
+	std::vector<BakedLevel> levelViews;
+};
+
+//writes a baked file, levels[0] is the full size image & every one after it half the last
+bool writeBakedTexture(const std::string& path, BlockFormat format, uint32_t flags, const std::vector<BakedLevel>& levels);
+
+#endif // !BAKEDTEXTURE_H
@@ -0,0 +1,33 @@
+#ifndef BCENCODER_H
+#define BCENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+//the gpu block compressed formats the baker writes, every one of them works on 4x4 texel blocks
+enum BlockFormat
+{
+	BLOCK_BC1, // 5:6:5 colour endpoints & 2 bit indices (+ 1 bit alpha), 8 bytes a block
+	BLOCK_BC3, // bc1 colour plus 8 bit alpha endpoints & 3 bit indices, 16 bytes a block
+	BLOCK_BC7, // rgba 7 bit endpoints & 4 bit indices (mode 6 only), 16 bytes a block
+	BLOCK_FORMAT_COUNT
+};
+
+size_t blockBytes(BlockFormat format);
+//"bc1", "bc3" & "bc7", nullptr for anything else
+const char* blockFormatName(BlockFormat format);
+//bytes a width x height image takes, partial blocks at the edges count as whole ones
+size_t compressedSize(BlockFormat format, int width, int height);
+
+//each takes the 16 rgba8 texels of a block (row by row) & writes one block
+void encodeBC1Block(const uint8_t* rgba, uint8_t* out);
+void encodeBC3Block(const uint8_t* rgba, uint8_t* out);
+void encodeBC7Block(const uint8_t* rgba, uint8_t* out);
+
+//compresses a whole rgba8 image into out (compressedSize bytes), blocks hanging off the edges
+//repeat the last row & column, with a pool the rows of blocks are spread over the workers
+void compressImage(BlockFormat format, const uint8_t* rgba, int width, int height, uint8_t* out, ThreadPool* pool = nullptr);
+
+#endif // !BCENCODER_H
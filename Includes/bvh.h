@@ -0,0 +1,52 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+#include <culling.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//bounding volume hierarchy over a static set of boxes, built with the binned surface
+//area heuristic & flattened depth first into one array (left child is always the next node)
+class Bvh
+{
+public:
+	//32 bytes so two nodes share a cache line
+	struct Node
+	{
+		float min[3];
+		uint32_t rightOrFirst; // interior: index of the right child, leaf: first entry in objects
+		float max[3];
+		uint32_t count;        // 0 for interior nodes
+	};
+
+	static const uint32_t leafSize = 4;
+
+	void build(const BoxSet& boxes);
+
+	//writes every object whose box touches the frustum to visible (room for all of them)
+	//& returns how many, whole subtrees inside the frustum are taken without testing
+	size_t queryFrustum(const Frustum& frustum, uint32_t* visible) const;
+	//the closest object box the ray hits within maxDistance, false when there's none
+	bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t& hit, float& distance) const;
+
+	size_t nodeCount() const { return nodes.size(); }
+	int depth() const { return maxDepth; }
+
+private:
+	std::vector<Node> nodes;
+	//object indices, every leaf & subtree covers a contiguous run of these
+	std::vector<uint32_t> objects;
+	//the run each node's subtree covers (only needed when a subtree is fully inside)
+	std::vector<uint32_t> subtreeFirst;
+	std::vector<uint32_t> subtreeCount;
+	//object boxes as min/max, kept for the leaf tests
+	std::vector<glm::vec3> boxMin, boxMax;
+	int maxDepth = 0;
+
+	uint32_t buildNode(std::vector<glm::vec3>& centroids, uint32_t first, uint32_t count, int depth);
+};
+
+#endif // !BVH_H
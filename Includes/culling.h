@@ -0,0 +1,58 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+//the 6 planes of a view frustum, normals point inwards & are normalized
+//so dot(plane.xyz, point) + plane.w is a signed distance
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	//gribb/hartmann extraction from projection * view
+	static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+	bool containsSphere(const glm::vec3& center, float radius) const;
+	bool containsBox(const glm::vec3& center, const glm::vec3& extent) const;
+};
+
+//bounding spheres as structure of arrays for the batch tests
+struct SphereSet
+{
+	std::vector<float> x, y, z, radius;
+
+	void add(const glm::vec3& center, float r);
+	void clear();
+	size_t size() const { return x.size(); }
+};
+
+//axis aligned boxes (center & half extent) as structure of arrays
+struct BoxSet
+{
+	std::vector<float> x, y, z, extentX, extentY, extentZ;
+
+	void add(const glm::vec3& center, const glm::vec3& extent);
+	void clear();
+	size_t size() const { return x.size(); }
+};
+
+//writes the indices of the spheres/boxes in [begin, end) that touch the frustum to
+//visible (in order) & returns how many there were, simd when available
+size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, size_t begin, size_t end, uint32_t* visible);
+size_t cullBoxes(const Frustum& frustum, const BoxSet& boxes, size_t begin, size_t end, uint32_t* visible);
+//one object at a time versions, the reference for the simd ones
+size_t cullSpheresScalar(const Frustum& frustum, const SphereSet& spheres, size_t begin, size_t end, uint32_t* visible);
+size_t cullBoxesScalar(const Frustum& frustum, const BoxSet& boxes, size_t begin, size_t end, uint32_t* visible);
+
+//whole set, split across the pool, visible needs room for every object
+//& ends up compacted in index order
+size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, uint32_t* visible, ThreadPool* pool);
+size_t cullBoxes(const Frustum& frustum, const BoxSet& boxes, uint32_t* visible, ThreadPool* pool);
+
+#endif // !CULLING_H
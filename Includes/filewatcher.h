@@ -0,0 +1,50 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//watches a set of files from its own thread & hands the ones that changed to whoever polls it,
+//inotify on linux (the directories are watched so editors that save by renaming still count)
+//& a last write time check every quarter second everywhere else
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	//starts watching path, already watched ones are ignored
+	void watch(const std::string& path);
+	//the watched files that changed since the last call (as they were passed to watch), never blocks
+	std::vector<std::string> changes();
+
+private:
+	struct Watched
+	{
+		std::string path;
+		//what the events are matched against
+		std::string canonical;
+		//last write time for the polling fallback
+		int64_t stamp;
+	};
+
+	std::vector<Watched> files;
+	std::vector<std::string> changed;
+	std::mutex mutex;
+	std::atomic<bool> stopping{ false };
+	std::thread thread;
+	int inotify = -1;
+	//inotify watch descriptor & the directory it's on
+	std::vector<std::pair<int, std::string>> directories;
+
+	void run();
+	void markChanged(const std::string& canonical);
+};
+
+#endif // !FILEWATCHER_H
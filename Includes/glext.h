@@ -0,0 +1,149 @@
+#ifndef GLEXT_H
+#define GLEXT_H
+
+#include <glad/glad.h>
+
+#include <string>
+
+// the glad loader in Libs/ only covers core 3.3, anything newer is loaded here
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+typedef void (APIENTRYP glextGetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP glextProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP glextProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP glextMaxShaderCompilerThreadsProc)(GLuint count);
+
+typedef void (APIENTRYP glextBufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP glextTexStorage3DProc)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+typedef void (APIENTRYP glextDrawElementsInstancedBaseInstanceProc)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLuint baseinstance);
+
+typedef void (APIENTRYP glextCreateBuffersProc)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRYP glextNamedBufferStorageProc)(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP glextCreateVertexArraysProc)(GLsizei n, GLuint* arrays);
+typedef void (APIENTRYP glextVertexArrayVertexBufferProc)(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+typedef void (APIENTRYP glextVertexArrayElementBufferProc)(GLuint vaobj, GLuint buffer);
+typedef void (APIENTRYP glextVertexArrayAttribFormatProc)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+typedef void (APIENTRYP glextVertexArrayAttribIFormatProc)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+typedef void (APIENTRYP glextVertexArrayAttribBindingProc)(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+typedef void (APIENTRYP glextVertexArrayBindingDivisorProc)(GLuint vaobj, GLuint bindingindex, GLuint divisor);
+typedef void (APIENTRYP glextEnableVertexArrayAttribProc)(GLuint vaobj, GLuint index);
+typedef void (APIENTRYP glextCreateTexturesProc)(GLenum target, GLsizei n, GLuint* textures);
+typedef void (APIENTRYP glextTextureStorage2DProc)(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (APIENTRYP glextTextureSubImage2DProc)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+typedef void (APIENTRYP glextTextureStorage3DProc)(GLuint texture, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+typedef void (APIENTRYP glextCompressedTextureSubImage2DProc)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data);
+typedef void (APIENTRYP glextTextureSubImage3DProc)(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels);
+typedef void (APIENTRYP glextTextureParameteriProc)(GLuint texture, GLenum pname, GLint param);
+typedef void (APIENTRYP glextGenerateTextureMipmapProc)(GLuint texture);
+
+//entry points & feature flags past 3.3, filled in by loadGLExtensions
+struct GLExtensions
+{
+	int majorVersion = 0;
+	int minorVersion = 0;
+
+	//GL_ARB_get_program_binary (core in 4.1)
+	bool programBinary = false;
+	glextGetProgramBinaryProc GetProgramBinary = nullptr;
+	glextProgramBinaryProc ProgramBinary = nullptr;
+	glextProgramParameteriProc ProgramParameteri = nullptr;
+
+	//GL_KHR_parallel_shader_compile (or the ARB version), GL_COMPLETION_STATUS_KHR can be polled without blocking
+	bool parallelShaderCompile = false;
+	glextMaxShaderCompilerThreadsProc MaxShaderCompilerThreads = nullptr;
+
+	//GL_ARB_buffer_storage (core in 4.4), immutable buffers that can stay mapped while the gpu reads them
+	bool bufferStorage = false;
+	glextBufferStorageProc BufferStorage = nullptr;
+
+	//GL_ARB_texture_storage (core in 4.2), immutable textures with every mip allocated up front
+	bool textureStorage = false;
+	glextTexStorage3DProc TexStorage3D = nullptr;
+
+	//GL_EXT_texture_compression_s3tc (bc1-3, an extension everywhere) & GL_ARB_texture_compression_bptc
+	//(bc7, core in 4.2), the formats baked textures come in
+	bool textureCompressionS3TC = false;
+	bool textureCompressionBPTC = false;
+
+	//GL_ARB_base_instance (core in 4.2), instanced attributes can start part way into their buffer
+	bool baseInstance = false;
+	glextDrawElementsInstancedBaseInstanceProc DrawElementsInstancedBaseInstance = nullptr;
+
+	//GL_ARB_direct_state_access (core in 4.5), objects are edited by name instead of bound first
+	bool directStateAccess = false;
+	glextCreateBuffersProc CreateBuffers = nullptr;
+	glextNamedBufferStorageProc NamedBufferStorage = nullptr;
+	glextCreateVertexArraysProc CreateVertexArrays = nullptr;
+	glextVertexArrayVertexBufferProc VertexArrayVertexBuffer = nullptr;
+	glextVertexArrayElementBufferProc VertexArrayElementBuffer = nullptr;
+	glextVertexArrayAttribFormatProc VertexArrayAttribFormat = nullptr;
+	glextVertexArrayAttribIFormatProc VertexArrayAttribIFormat = nullptr;
+	glextVertexArrayAttribBindingProc VertexArrayAttribBinding = nullptr;
+	glextVertexArrayBindingDivisorProc VertexArrayBindingDivisor = nullptr;
+	glextEnableVertexArrayAttribProc EnableVertexArrayAttrib = nullptr;
+	glextCreateTexturesProc CreateTextures = nullptr;
+	glextTextureStorage2DProc TextureStorage2D = nullptr;
+	glextTextureSubImage2DProc TextureSubImage2D = nullptr;
+	glextTextureStorage3DProc TextureStorage3D = nullptr;
+	glextTextureSubImage3DProc TextureSubImage3D = nullptr;
+	glextCompressedTextureSubImage2DProc CompressedTextureSubImage2D = nullptr;
+	glextTextureParameteriProc TextureParameteri = nullptr;
+	glextGenerateTextureMipmapProc GenerateTextureMipmap = nullptr;
+
+	//what the driver reported, for the log
+	std::string renderer;
+	std::string version;
+
+	//instance data goes through a persistently mapped ring instead of orphaning the buffer every frame
+	bool persistentStreaming() const { return bufferStorage && baseInstance; }
+	//turns every feature above off so everything takes the plain 3.3 path (to compare against)
+	void disableFastPaths();
+};
+
+extern GLExtensions glext;
+
+//call once after gladLoadGLLoader with the same loader function
+void loadGLExtensions(GLADloadproc load);
+//checks the context's extension list (needs a current context)
+bool hasGLExtension(const char* name);
+//the version, renderer, which features were found & the path each part of the renderer takes because of them,
+//printed at startup so benchmark numbers from different machines can be told apart
+std::string describeGLPaths();
+
+#endif // !GLEXT_H
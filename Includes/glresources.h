@@ -0,0 +1,16 @@
+#ifndef GLRESOURCES_H
+#define GLRESOURCES_H
+
+#include <cstddef>
+
+//creates vertex arrays & buffers through direct state access when the driver has it (glext.directStateAccess),
+//nothing gets bound to make or fill them, otherwise the 3.3 bind to edit calls go through glstate
+
+//an empty vertex array, the DSA one isn't bound
+unsigned int createVertexArray();
+//a buffer holding data that never changes, immutable storage with DSA (the driver can place it for good)
+unsigned int createStaticBuffer(size_t bytes, const void* data);
+//makes indexBuffer the vertex array's GL_ELEMENT_ARRAY_BUFFER (the 3.3 path leaves the vertex array bound)
+void setIndexBuffer(unsigned int vertexArray, unsigned int indexBuffer);
+
+#endif // !GLRESOURCES_H
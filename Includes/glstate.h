@@ -0,0 +1,106 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <glad/glad.h>
+
+#include <string>
+
+//what GLState tracks, the stats are kept per kind
+enum GLStateKind
+{
+	GLSTATE_PROGRAM,
+	GLSTATE_VERTEX_ARRAY,
+	GLSTATE_BUFFER,
+	GLSTATE_TEXTURE,
+	GLSTATE_POLYGON_MODE,
+	GLSTATE_DEPTH,
+	GLSTATE_BLEND,
+	GLSTATE_KIND_COUNT
+};
+
+//calls that went to the driver & calls that were dropped for setting what was already set
+struct GLStateStats
+{
+	unsigned long long issued[GLSTATE_KIND_COUNT] = {};
+	unsigned long long elided[GLSTATE_KIND_COUNT] = {};
+
+	unsigned long long totalIssued() const;
+	unsigned long long totalElided() const;
+};
+
+//shadows the gl state we change a lot so setting it again is free, everything that
+//binds these should go through here or call invalidate() after touching gl directly
+class GLState
+{
+public:
+	static const int maxTextureUnits = 16;
+
+	GLState() { invalidate(); }
+
+	void useProgram(unsigned int program);
+	void bindVertexArray(unsigned int vertexArray);
+	//GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER & GL_PIXEL_UNPACK_BUFFER are cached, anything else
+	//(GL_ELEMENT_ARRAY_BUFFER belongs to the bound VAO) always goes through
+	void bindBuffer(unsigned int target, unsigned int buffer);
+	//indexed GL_UNIFORM_BUFFER bindings, also binds the generic target like gl does
+	void bindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+	void activeTexture(unsigned int unit);
+	//binds to unit (switching the active unit only if it needs to), unit is 0 based
+	void bindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+	//for creating/uploading a texture, binds it to whichever unit is already active
+	void bindTextureForEdit(unsigned int target, unsigned int texture);
+
+	void polygonMode(unsigned int mode);
+	void setDepthTest(bool enabled);
+	void depthFunc(unsigned int func);
+	void depthMask(bool write);
+	void setBlend(bool enabled);
+	void blendFunc(unsigned int source, unsigned int destination);
+
+	//forgets everything so the next call of each kind goes through (new context, outside gl code)
+	void invalidate();
+	//deleted objects have to be forgotten or a new one reusing the name would be skipped
+	void forgetBuffer(unsigned int buffer);
+	void forgetTexture(unsigned int texture);
+	void forgetProgram(unsigned int program);
+	void forgetVertexArray(unsigned int vertexArray);
+
+	//starts a new frame of stats, the last one is kept in lastFrame()
+	void beginFrame();
+	const GLStateStats& lastFrame() const { return previousFrame; }
+	const GLStateStats& total() const { return totals; }
+	//one line per kind with the issued/elided calls over the whole run
+	std::string summary() const;
+
+private:
+	//~0u is "unknown", nothing real has that name
+	static const unsigned int unknown = ~0u;
+
+	unsigned int program = unknown;
+	unsigned int vertexArray = unknown;
+	unsigned int arrayBuffer = unknown;
+	unsigned int uniformBuffer = unknown;
+	unsigned int pixelUnpackBuffer = unknown;
+	unsigned int uniformBufferBases[16];
+	unsigned int activeUnit = unknown;
+	unsigned int textures2D[maxTextureUnits];
+	unsigned int polygonFill = unknown;
+	int depthTest = -1;
+	unsigned int depthFunction = unknown;
+	int depthWrite = -1;
+	int blend = -1;
+	unsigned int blendSource = unknown;
+	unsigned int blendDestination = unknown;
+
+	GLStateStats frame;
+	GLStateStats previousFrame;
+	GLStateStats totals;
+
+	//true when the call has to be made, counts it either way
+	bool change(GLStateKind kind, bool changed);
+	unsigned int* bufferSlot(unsigned int target);
+};
+
+extern GLState glstate;
+
+#endif // !GLSTATE_H
@@ -0,0 +1,25 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//64 bit FNV-1a, used to key the lookup tables (uniform names etc.)
+inline uint64_t hashBytes(const void* data, size_t length, uint64_t seed = 14695981039346656037ull)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t hash = seed;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+inline uint64_t hashString(const std::string& str)
+{
+	return hashBytes(str.data(), str.size());
+}
+
+#endif // !HASH_H
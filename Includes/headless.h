@@ -0,0 +1,10 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+//creates an offscreen GL 3.3 core context through EGL (works on mesa's
+//llvmpipe with no display or gpu), loads glad against it & prints describeGLPaths
+bool createHeadlessContext();
+//releases the context made by createHeadlessContext
+void destroyHeadlessContext();
+
+#endif // !HEADLESS_H
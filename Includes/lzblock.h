@@ -0,0 +1,17 @@
+#ifndef LZBLOCK_H
+#define LZBLOCK_H
+
+#include <cstddef>
+
+//a byte oriented lz77 codec in lz4's block format (a token with the literal & match lengths, the literals,
+//a 16 bit back offset & length extension bytes), greedy with one hash probe a position so it's fast
+//rather than small, & decoding is a few memcpys a match, used for the asset pack's compressed blobs
+
+//the most compressing size bytes can take (incompressible data grows a little)
+size_t lzCompressBound(size_t size);
+//compresses into out (capacity bytes), the compressed size or 0 when it didn't fit
+size_t lzCompress(const unsigned char* in, size_t size, unsigned char* out, size_t capacity);
+//decompresses exactly outSize bytes, false on anything malformed (never reads or writes out of bounds)
+bool lzDecompress(const unsigned char* in, size_t size, unsigned char* out, size_t outSize);
+
+#endif // !LZBLOCK_H
@@ -0,0 +1,37 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+//a whole file mapped read only into memory, the os pages it in as it's read
+//& there's no copy into our own buffers, unmapped when it's closed or destroyed
+class MappedFile
+{
+public:
+	MappedFile() {}
+	~MappedFile();
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//false when the file can't be opened (an empty file opens fine with no data)
+	bool open(const std::string& path);
+	void close();
+
+	const char* data() const { return bytes; }
+	size_t size() const { return length; }
+	bool isOpen() const { return opened; }
+
+private:
+	const char* bytes = nullptr;
+	size_t length = 0;
+	bool opened = false;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+#endif // !MAPPEDFILE_H
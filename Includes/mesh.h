@@ -0,0 +1,41 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//vertices (stride floats each, interleaved like the cube's position + uv) plus the triangle list indexing them
+struct IndexedMesh
+{
+	unsigned int stride = 0;
+	std::vector<float> vertices;
+	std::vector<uint32_t> indices;
+
+	size_t vertexCount() const { return stride ? vertices.size() / stride : 0; }
+	size_t indexCount() const { return indices.size(); }
+	//16 bit indices are enough (and half the size) below 65536 vertices
+	bool shortIndices() const { return vertexCount() <= 65536; }
+	size_t vertexBytes() const { return vertices.size() * sizeof(float); }
+	size_t indexBytes() const { return indices.size() * (shortIndices() ? sizeof(uint16_t) : sizeof(uint32_t)); }
+	//the indices narrowed for GL_UNSIGNED_SHORT
+	std::vector<uint16_t> shortIndexData() const;
+};
+
+//welds a triangle soup (every 3 vertices is a triangle, like the old vertices[] array)
+//into unique vertices & indices, then reorders both for the vertex caches
+IndexedMesh buildIndexedMesh(const float* vertices, size_t vertexCount, unsigned int stride);
+
+//merges bit identical vertices, indices come out in the soup's triangle order
+IndexedMesh weldVertices(const float* vertices, size_t vertexCount, unsigned int stride);
+//reorders the triangles so vertices get reused while they're still in the post transform cache
+//(forsyth's linear speed optimizer with a 32 entry lru model)
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+//renumbers the vertices in the order the indices first use them so fetches walk memory forwards
+void optimizeVertexFetch(IndexedMesh& mesh);
+
+//average cache misses per triangle for a fifo post transform cache of cacheSize entries,
+//3.0 is no reuse at all & ~0.5 is the best a regular grid can do
+float averageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+#endif // !MESH_H
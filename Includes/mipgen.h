@@ -0,0 +1,43 @@
+#ifndef MIPGEN_H
+#define MIPGEN_H
+
+#include <vector>
+
+class ThreadPool;
+
+//how each level is filtered from the one above it
+enum MipFilter
+{
+	MIP_BOX, // the area each texel covers, a plain 2x2 average on even sizes
+	MIP_KAISER, // kaiser windowed sinc, sharper & less aliasing at a few more taps
+	MIP_FILTER_COUNT
+};
+
+struct MipOptions
+{
+	MipFilter filter = MIP_BOX;
+	//the colour channels are srgb encoded, they're filtered in linear light & encoded back
+	//(averaging the encoded values darkens every level), alpha is always linear
+	bool srgb = true;
+	//the sse/avx kernels, off runs the scalar reference they're checked against
+	bool simd = true;
+};
+
+//one level of the chain, rgba8
+struct MipLevel
+{
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> pixels;
+};
+
+//every level below a width x height rgba8 image down to 1x1 (level 1 onwards, not the image itself),
+//sizes halve rounding down like gl's chain so odd (npot) sizes get filtered over the 2-3 texels each
+//one covers instead of dropping a row or column, every level is filtered from a float copy of the last
+//& with a pool the rows of each pass are spread over the workers (don't pass one from inside a pool job)
+void generateMips(const unsigned char* rgba, int width, int height, const MipOptions& options, std::vector<MipLevel>& levels, ThreadPool* pool = nullptr);
+
+//"box" & "kaiser", nullptr for anything else
+const char* mipFilterName(MipFilter filter);
+
+#endif // !MIPGEN_H
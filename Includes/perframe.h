@@ -0,0 +1,37 @@
+#ifndef PERFRAME_H
+#define PERFRAME_H
+
+#include <glm/glm.hpp>
+
+//binding point every program's PerFrame block gets attached to (see Shader::bindBlock)
+const unsigned int perFrameBinding = 0;
+
+//mirror of the std140 PerFrame block in the shaders:
+//  layout (std140) uniform PerFrame { mat4 view; mat4 projection; mat4 viewProjection; vec3 cameraPosition; float time; };
+//the vec3 is padded to 16 bytes in std140 so time slots into its last 4
+struct PerFrameData
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+	glm::vec3 cameraPosition;
+	float time;
+};
+static_assert(sizeof(PerFrameData) == 208, "PerFrameData has to match the std140 layout of the PerFrame block");
+
+//the uniform buffer behind the PerFrame block, written once a frame & shared by every program
+class PerFrameBuffer
+{
+public:
+	//makes the buffer & registers the block binding, call before building the shaders
+	void create();
+	void release();
+
+	//uploads this frame's data & binds it to perFrameBinding
+	void update(const PerFrameData& data);
+
+private:
+	unsigned int UBO = 0;
+};
+
+#endif // !PERFRAME_H
@@ -0,0 +1,120 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//log scale histogram of times, 6 buckets per doubling from 1us up to a few seconds
+struct TimeHistogram
+{
+	static const int bucketCount = 128;
+	uint32_t counts[bucketCount] = {};
+	uint64_t total = 0;
+
+	void add(double ms);
+	//the time (ms) p of the samples are at or under, p from 0 to 1
+	double percentile(double p) const;
+};
+
+//frame timing: scoped cpu zones, gpu GL_TIME_ELAPSED zones read back a few frames late
+//so they never stall, per zone histograms & an optional chrome trace (chrome://tracing)
+//only meant to be used from the gl thread
+class Profiler
+{
+public:
+	//how many frames a gpu query gets before its result is read
+	static const int gpuLatency = 4;
+
+	void beginFrame();
+	void endFrame();
+
+	void beginZone(const char* name);
+	//closes the innermost zone, which should be name (a misnested end closes the zone it names
+	//instead & one with no open zone of that name is dropped, both print an error the first time)
+	void endZone(const char* name);
+	//gpu zones can't nest (only one GL_TIME_ELAPSED query runs at a time)
+	void beginGpuZone(const char* name);
+	void endGpuZone();
+
+	//starts recording every zone for writeChromeTrace
+	void enableTrace(bool enable) { tracing = enable; }
+	bool writeChromeTrace(const std::string& path) const;
+
+	//one line per zone with p50/p95/p99
+	std::string summary() const;
+	//the cpu (or gpu) histogram for a zone, "frame" is the whole frame
+	const TimeHistogram* histogram(const char* name, bool gpu = false) const;
+
+	//deletes the query objects, call while the context is still alive
+	void release();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Zone
+	{
+		std::string name;
+		bool gpu;
+		TimeHistogram histogram;
+		double frameTotal = 0.0; // this frame so far
+	};
+	struct TraceEvent
+	{
+		int zone;
+		double start; // microseconds since the profiler started
+		double duration;
+	};
+	struct GpuQuery
+	{
+		unsigned int query;
+		int zone;
+		double start;
+	};
+	struct OpenZone
+	{
+		int zone;
+		Clock::time_point start;
+	};
+
+	std::vector<Zone> zones;
+	std::vector<OpenZone> open;
+	std::vector<TraceEvent> trace;
+	bool tracing = false;
+	bool reportedMismatch = false;
+	Clock::time_point epoch = Clock::now();
+	Clock::time_point frameStart;
+
+	//queries issued per frame, in a ring gpuLatency frames deep
+	std::vector<GpuQuery> gpuFrames[gpuLatency];
+	std::vector<unsigned int> freeQueries;
+	int gpuFrame = 0;
+	bool gpuZoneOpen = false;
+
+	int zoneIndex(const char* name, bool gpu);
+	double sinceEpoch(Clock::time_point time) const;
+	void collectGpuFrame(int frame, bool wait);
+};
+
+extern Profiler profiler;
+
+//times the rest of the enclosing scope as a cpu zone
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name) : name(name) { profiler.beginZone(name); }
+	~ProfileZone() { profiler.endZone(name); }
+private:
+	const char* name;
+};
+
+//times the gpu work issued in the rest of the enclosing scope
+class GpuProfileZone
+{
+public:
+	explicit GpuProfileZone(const char* name) { profiler.beginGpuZone(name); }
+	~GpuProfileZone() { profiler.endGpuZone(); }
+};
+
+#endif // !PROFILER_H
@@ -0,0 +1,141 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+#include <shader.h>
+#include <shadervariants.h>
+#include <transforms.h>
+#include <textureloader.h>
+#include <texturecache.h>
+#include <texturearray.h>
+#include <culling.h>
+#include <bvh.h>
+#include <perframe.h>
+#include <streambuffer.h>
+#include <filewatcher.h>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+//how the cube scene gets built & drawn
+struct SceneOptions
+{
+	//draws every cube with one glDrawElementsInstanced instead of one draw per cube
+	bool instanced = false;
+	//how many cubes get drawn, the first 10 are cubePositions & the rest are scattered around them
+	unsigned int cubeCount = 10;
+	//skips cubes outside the view frustum before computing their matrices & drawing them
+	bool cull = true;
+	//culls by walking a bvh over the cubes instead of testing every one of them
+	bool bvh = false;
+	//stores the cube's vertices as half floats (see CompactCubeVertex in scene.cpp)
+	bool compactVertices = false;
+	//samples every cube's images out of one texture array, each cube with its own pair of layers
+	bool textureArray = false;
+	//builds the textures' mip chains on the workers with this filter instead of glGenerateMipmap
+	bool cpuMips = false;
+	MipFilter mipFilter = MIP_BOX;
+	//what the texture cache may keep on the gpu before it evicts textures nothing uses any more
+	size_t textureBudget = 256u << 20;
+	//rebuilds the cube shader when shaders/ changes on disk & swaps it in between frames
+	bool watchShaders = false;
+};
+
+//the spinning textured cubes, everything that isn't the window or input lives here
+//so the windowed & headless paths draw exactly the same thing
+class Scene
+{
+public:
+	//compiles the shaders, makes the buffers & starts the textures loading,
+	//root is the folder holding shaders/ and assets/
+	Scene(const std::filesystem::path& root, ThreadPool& workers, const SceneOptions& options);
+	//deletes the gl objects, call while the context is still alive
+	void release();
+
+	//draws one frame (clearing first), time drives the cube animation
+	void render(const glm::mat4& view, const glm::mat4& projection, float time);
+
+	const SceneOptions& options() const { return sceneOptions; }
+	//how many cubes the last render actually drew (after culling)
+	size_t drawnCubes() const { return drawCount; }
+	TextureLoader& textures() { return textureLoader; }
+	TextureCache& textureCache() { return cache; }
+	//blocks until the shader is linked & every texture is uploaded
+	void finishLoading();
+
+	//the closest cube along the ray (direction normalized), -1 when it hits nothing
+	int pick(const glm::vec3& origin, const glm::vec3& direction, float& distance) const;
+
+private:
+	SceneOptions sceneOptions;
+	ThreadPool& workers;
+	//the cube shader's variants (built without blocking), the one this scene uses
+	//& the flat shader drawn until it's ready
+	ShaderVariants shaders;
+	uint64_t shaderMask = 0;
+	Shader fallbackShader;
+	//whichever of the two the uniform handles were looked up in (& the program it had, a hot reload changes it)
+	Shader* currentShader = nullptr;
+	unsigned int currentProgram = 0;
+	//tells the scene which shader files changed (watchShaders only)
+	std::unique_ptr<FileWatcher> shaderWatcher;
+	TextureLoader textureLoader;
+	//every 2d texture the scene uses comes through here, so asking for one twice doesn't load it twice
+	TextureCache cache;
+
+	//every cube in the scene (cubePositions plus any extra ones asked for)
+	std::vector<glm::vec3> cubes;
+	//the cubes' animated model matrices
+	TransformSystem cubeTransforms;
+	std::vector<glm::mat4> instanceMatrices;
+	//bounding spheres for culling (the cubes only spin in place so these never move)
+	SphereSet cubeBounds;
+	//hierarchy over the cubes' boxes, used for --bvh culling & picking
+	Bvh cubeTree;
+	//indices of the cubes that survived culling this frame
+	std::vector<uint32_t> visibleCubes;
+	size_t drawCount = 0;
+
+	//Vertex Array Object (i.e stores vertex attributes)
+	unsigned int VAO = 0;
+	//Vertex Buffer Object (stores GPU memory for the vertex shader)
+	unsigned int VBO = 0;
+	//Element Buffer Object (stores element array gpu memory)
+	unsigned int EBO = 0;
+	//what's in the EBO, the welded cube's triangle list
+	unsigned int cubeIndexCount = 0;
+	unsigned int cubeIndexType = 0;
+	//Instance Buffer Object (one model matrix per cube for the instanced path), rewritten every frame
+	StreamBuffer instanceStream;
+
+	unsigned int texture1 = 0;
+	unsigned int texture2 = 0;
+
+	//textureArray only, the cube images as layers of one array, the layer each image got
+	//& the pair of layers every cube mixes (base | overlay << 16)
+	TextureArrayBuilder textureArrays;
+	std::vector<TextureLayer> layers;
+	std::vector<uint32_t> cubeMaterials;
+	//the visible cubes' layer pairs, written next to the instance matrices every frame
+	StreamBuffer materialStream;
+	UniformHandle layersLoc;
+
+	//camera uniforms shared by every program
+	PerFrameBuffer perFrame;
+	UniformHandle modelLoc;
+
+	void prepareCubes();
+	void prepareTransforms();
+	void prepareTree();
+	void prepareBuffers();
+	void prepareTextures(const std::filesystem::path& root);
+	//the shader to draw with this frame, switches over to the real one once it's done
+	Shader& activeShader();
+	//rebuilds the variants whose files changed & swaps in the ones that finished
+	void reloadShaders();
+};
+
+#endif // !SCENE_H
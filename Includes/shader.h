@@ -3,20 +3,66 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <shadersource.h>
 
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
+
+//a uniform location resolved once through Shader::uniform, so setting it
+//every draw skips the name lookup entirely
+struct UniformHandle
+{
+	int location = -1;
+
+	bool valid() const { return location >= 0; }
+};
 
 class Shader
 {
 public:
 	//the programs ID
-	unsigned int ID;
+	unsigned int ID = 0;
+
+	//folder linked program binaries are cached in between runs, empty turns the cache off
+	static std::string cacheDirectory;
 
-	//constructer to build & read the shader
+	//points the named uniform block of every program linked afterwards at binding
+	//(glsl 330 has no layout(binding =) so it's done after linking)
+	static void bindBlock(const std::string& name, unsigned int binding);
+
+	//an empty shader for submit to build into
+	Shader() {}
+	//constructer to build & read the shader (blocks until it's linked, same as submit + finish)
 	Shader(const char* vertexPath, const char* fragmentPath);
+
+	//reads the files (through shaderSources, so #include works) & kicks off the compile & link without waiting on the driver
+	bool submit(const char* vertexPath, const char* fragmentPath);
+	bool submitSource(const std::string& vertexCode, const std::string& fragmentCode);
+	bool submitSource(const ShaderSource& vertexSource, const ShaderSource& fragmentSource);
+	//links stages compiled with compileStage, they stay the caller's to delete (so a hot reload can
+	//relink with only the stage that changed recompiled)
+	bool submitStages(unsigned int vertexStage, unsigned int fragmentStage);
+	//starts compiling one stage (GL_VERTEX_SHADER / GL_FRAGMENT_SHADER), errors are printed when it's linked
+	static unsigned int compileStage(unsigned int type, const ShaderSource& source);
+	//true once the program can be used without stalling, polls GL_COMPLETION_STATUS_KHR when
+	//the driver compiles in parallel (otherwise it just finishes) & runs finish when it's done
+	bool ready();
+	//waits for the compile & link, prints any errors & reads the uniforms, true when it linked
+	bool finish();
+	//whether the finished program linked (false while it's still building)
+	bool linked() const { return linkStatus; }
 	//use/activate the shader
 	void use();
 
+	//sets every uniform this program shares with from (same name & type) to from's value,
+	//so a rebuilt program picks up where the old one left off
+	void copyUniforms(const Shader& from);
+
+	//looks a uniform up in the table built after linking (no driver call)
+	UniformHandle uniform(const std::string& name) const;
+
 	// utility uniform functions
 	void setBool(const std::string& name, bool value) const;
 	void setInt(const std::string& name, int value) const;
@@ -30,16 +76,83 @@ public:
 	void setMat2(const std::string& name, const glm::mat2& mat) const;
 	void setMat3(const std::string& name, const glm::mat3& mat) const;
 	void setMat4(const std::string& name, const glm::mat4& mat) const;
+
+	// handle based versions for the per draw path
+	// (every setter skips the upload when the value is the same as the last one set)
+	void setBool(UniformHandle handle, bool value) const;
+	void setInt(UniformHandle handle, int value) const;
+	void setFloat(UniformHandle handle, float value) const;
+	void setVec2(UniformHandle handle, const glm::vec2& value) const;
+	void setVec3(UniformHandle handle, const glm::vec3& value) const;
+	void setVec4(UniformHandle handle, const glm::vec4& value) const;
+	void setMat2(UniformHandle handle, const glm::mat2& mat) const;
+	void setMat3(UniformHandle handle, const glm::mat3& mat) const;
+	void setMat4(UniformHandle handle, const glm::mat4& mat) const;
 	
-	bool getBool(const std::string& name);
-	int getInt(const std::string& name);
-	float getFloat(const std::string& name);
-	glm::vec2 getVec2(const std::string& name);
-	glm::vec3 getVec3(const std::string& name);
-	glm::vec4 getVec4(const std::string& name);
-	glm::mat2 getMat2(const std::string& name);
-	glm::mat3 getMat3(const std::string& name);
-	glm::mat4 getMat4(const std::string& name);
+	// read back from the cpu copy of the uniforms, no driver round trip
+	bool getBool(const std::string& name) const;
+	int getInt(const std::string& name) const;
+	float getFloat(const std::string& name) const;
+	glm::vec2 getVec2(const std::string& name) const;
+	glm::vec3 getVec3(const std::string& name) const;
+	glm::vec4 getVec4(const std::string& name) const;
+	glm::mat2 getMat2(const std::string& name) const;
+	glm::mat3 getMat3(const std::string& name) const;
+	glm::mat4 getMat4(const std::string& name) const;
+
+private:
+	//an active uniform found by reflection after linking
+	struct UniformInfo
+	{
+		uint64_t hash;
+		int location;
+		unsigned int type;
+		int size;
+		std::string name;
+	};
+
+	//flat list of uniforms plus an open addressed table of indices into it
+	std::vector<UniformInfo> uniforms;
+	std::vector<int> uniformTable;
+
+	//the shaders of a submitted program until finish checks & deletes them
+	unsigned int vertexShader = 0;
+	unsigned int fragmentShader = 0;
+	//false for submitStages, the stages belong to the caller
+	bool ownsStages = true;
+	bool building = false;
+	bool linkStatus = false;
+	std::string binaryPath;
+
+	//uniform block name -> binding point, applied by reflectUniforms
+	static std::vector<std::pair<std::string, unsigned int>> blockBindings;
+
+	//where a uniform's cpu copy lives in shadowValues, in 32 bit words (floats or ints)
+	struct ShadowSlot
+	{
+		int offset = -1;
+		int words = 0;
+	};
+	//indexed by location, the copies start as the values the program linked with &
+	//follow every set so the getters never have to ask the driver
+	std::vector<ShadowSlot> shadowSlots;
+	mutable std::vector<uint32_t> shadowValues;
+
+	//program binary cache (see cacheDirectory)
+	static std::string binaryCachePath(const ShaderSource& vertexSource, const ShaderSource& fragmentSource);
+	bool loadBinary(const std::string& path);
+	void saveBinary(const std::string& path);
+
+	void reflectUniforms();
+	void addUniform(const std::string& name, int location, unsigned int type, int size);
+	int findLocation(const std::string& name) const;
+	void addShadow(int location, unsigned int type);
+	//copies value into the shadow, false when it was already there so the upload can be skipped
+	bool updateShadow(int location, const void* value, int words) const;
+	//the shadow of location, nullptr when it doesn't have one of that size
+	const uint32_t* readShadow(int location, int words) const;
+	//uploads words of value to a uniform of type (program has to be in use)
+	void uploadUniform(int location, unsigned int type, const uint32_t* value) const;
 };
 
 #endif // !SHADER_H
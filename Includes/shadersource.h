@@ -0,0 +1,123 @@
+#ifndef SHADERSOURCE_H
+#define SHADERSOURCE_H
+
+#include <mappedfile.h>
+#include <assetpack.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//a shader's code as a list of pieces for glShaderSource(count, strings, lengths), most
+//point straight into mapped files so nothing gets concatenated
+class ShaderSource
+{
+public:
+	ShaderSource() {}
+	ShaderSource(ShaderSource&&) = default;
+	ShaderSource& operator=(ShaderSource&&) = default;
+	//the owned text's pieces point at this object's own strings, so no copies
+	ShaderSource(const ShaderSource&) = delete;
+	ShaderSource& operator=(const ShaderSource&) = delete;
+
+	//a piece of memory that outlives the source (a mapped file)
+	void add(const char* data, size_t length);
+	//a piece the source keeps its own copy of (#line directives, defines)
+	void addText(const std::string& text);
+	//another source's pieces, its owned text is copied & the rest shared
+	void append(const ShaderSource& other);
+
+	//a copy with text put right after the #version line followed by a #line, so errors still
+	//point at the right lines (used for the variant #defines)
+	ShaderSource withPrelude(const std::string& text) const;
+
+	size_t count() const { return strings.size(); }
+	const char* const* pieces() const { return strings.data(); }
+	const int* lengths() const { return pieceLengths.data(); }
+	bool empty() const { return strings.empty(); }
+	//fnv-1a over the pieces, the same as hashing the concatenated code
+	uint64_t hash(uint64_t seed = 14695981039346656037ull) const;
+	//the concatenated code, for debugging
+	std::string str() const;
+
+private:
+	std::vector<const char*> strings;
+	std::vector<int> pieceLengths;
+	std::vector<bool> owned;
+	//deque so the pieces pointing in here never move
+	std::deque<std::string> text;
+};
+
+//reads shader files through mmap (or out of the asset pack when one's open) & expands #include "file" (relative to the including file),
+//every file is mapped & scanned once per process (until reload) & each is included at most once per shader
+//(like #pragma once), the graph is memoized so hundreds of variants sharing a big library
+//only ever touch it once
+class ShaderSourceLoader
+{
+public:
+	//the file with its includes expanded, false (& an error printed) when something's missing
+	bool load(const std::string& path, ShaderSource& source);
+	//the file a #line source number refers to ("0(12) : error" is fileName(0) line 12)
+	const std::string& fileName(int id) const;
+	//maps the file again after it changed on disk & rescans its #includes, ShaderSources made before
+	//stay valid but keep the old text, load them again to pick the change up
+	bool reload(const std::string& path);
+	//unmaps what reload replaced, call once every ShaderSource made before the reloads has been
+	//loaded again or dropped (gl copies the text at glShaderSource, so compiles in flight don't count)
+	void releaseRetired();
+	//whether root is path or pulls it in through its #includes (both already loaded)
+	bool includes(const std::string& root, const std::string& path) const;
+	//every file loaded so far, includes too (what a watcher should look at)
+	std::vector<std::string> paths() const;
+	//every mapping is closed, ShaderSources made from them can't be used after this
+	void clear();
+
+	size_t fileCount() const { return files.size(); }
+
+private:
+	struct File;
+	//a run of the file's own text or an #include of another file
+	struct Segment
+	{
+		const char* data;
+		size_t length;
+		File* include;
+		//the line the file carries on from after an include
+		int resumeLine;
+	};
+	struct File
+	{
+		int id;
+		std::string path;
+		//the text, in mapping or packed (a reload always goes to the file on disk)
+		const char* data;
+		size_t size;
+		MappedFile mapping;
+		AssetSpan packed;
+		std::vector<Segment> segments;
+		bool valid;
+	};
+
+	//canonical path -> file
+	std::unordered_map<std::string, std::unique_ptr<File>> files;
+	std::vector<File*> filesById;
+	//mappings (& unpacked text) replaced by reload, sources might still point into them
+	std::deque<MappedFile> retired;
+	std::deque<AssetSpan> retiredPacked;
+
+	File* open(const std::string& path);
+	//points the file at its text, from the pack when fromPack & it's in there
+	bool read(File* file, bool fromPack);
+	File* find(const std::string& path) const;
+	void scan(File* file);
+	bool expand(File* file, ShaderSource& source, std::vector<File*>& included);
+};
+
+//the process wide loader, what Shader::submit reads files through
+extern ShaderSourceLoader shaderSources;
+
+#endif // !SHADERSOURCE_H
@@ -0,0 +1,73 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include <shader.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//every permutation of one vertex/fragment pair, a variant is the sources with a #define
+//for each keyword in its mask put right after the #version line, so features get
+//compiled in or out instead of branched on at runtime
+class ShaderVariants
+{
+public:
+	ShaderVariants() {}
+	//maps the sources & their includes once (see ShaderSourceLoader), bit i of a mask is keywords[i] (64 at most)
+	ShaderVariants(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& keywords);
+
+	//the mask bit for a keyword, 0 for one the shader doesn't declare
+	uint64_t keyword(const std::string& name) const;
+
+	//starts building the variant without waiting (see Shader::submit)
+	void prepare(uint64_t mask);
+	//the variant if it's built & linked, nullptr while it's still compiling (or failed), never blocks
+	Shader* tryGet(uint64_t mask);
+	//the variant, building it & waiting for it the first time
+	Shader& get(uint64_t mask);
+
+	size_t count() const { return variants.size(); }
+	//deletes every variant's program, call while the context is still alive
+	void release();
+
+	//starts rebuilding the variants whose vertex or fragment source pulls in one of the files
+	//(already reloaded by shaderSources), the live programs keep drawing meanwhile, returns how many,
+	//variants start out from the binary cache with no stages kept so the first reload compiles both,
+	//the stages are kept from then on so later ones only recompile the stage that changed
+	//(or one a failed rebuild left stale)
+	size_t reload(const std::vector<std::string>& changedFiles);
+	//swaps in the rebuilds that finished linking, call between frames, the Shader objects stay
+	//the same (only their program changes) & their uniforms carry over, returns how many swapped
+	size_t update();
+
+private:
+	struct Variant
+	{
+		//unique_ptr so handing out references survives rehashing & swapping rebuilds in
+		std::unique_ptr<Shader> shader;
+		//a rebuild that hasn't finished linking yet
+		std::unique_ptr<Shader> pending;
+		//vertex & fragment stages kept for relinking (once reloaded), the pending ones can share them
+		unsigned int stages[2] = {};
+		unsigned int pendingStages[2] = {};
+	};
+
+	std::string vertexPath;
+	std::string fragmentPath;
+	ShaderSource vertexSource;
+	ShaderSource fragmentSource;
+	std::vector<std::string> keywords;
+	//mask -> variant
+	std::unordered_map<uint64_t, Variant> variants;
+
+	Shader& variant(uint64_t mask);
+	std::string defines(uint64_t mask) const;
+	//deletes a rebuild (failed or out of date) & whichever of its stages the live program doesn't use,
+	//the live program's stages it had replaced are dropped too so the next reload recompiles them
+	void dropPending(Variant& variant);
+};
+
+#endif // !SHADERVARIANTS_H
@@ -0,0 +1,98 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// thin wrappers so the batch kernels (transforms, culling etc.) are written once for
+// both avx2 (8 lanes) & sse2 (4 lanes), SIMD_AVAILABLE is left undefined when neither is
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#include <cstdint>
+#define SIMD_AVAILABLE 1
+
+namespace simd {
+
+#if defined(__AVX2__)
+typedef __m256 vfloat;
+typedef __m256i vint;
+const int width = 8;
+inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+inline void vstore(float* p, vfloat a) { _mm256_storeu_ps(p, a); }
+inline vfloat vgather(const float* base, const uint32_t* indices) { return _mm256_i32gather_ps(base, _mm256_loadu_si256((const __m256i*)indices), 4); }
+inline vfloat vset(float x) { return _mm256_set1_ps(x); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+inline vfloat vand(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+inline vfloat vor(vfloat a, vfloat b) { return _mm256_or_ps(a, b); }
+inline vfloat vxor(vfloat a, vfloat b) { return _mm256_xor_ps(a, b); }
+inline vfloat vabs(vfloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline vfloat vless(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline vfloat vselect(vfloat mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, mask); }
+//one bit per lane, set where the mask lane is set
+inline int vmovemask(vfloat mask) { return _mm256_movemask_ps(mask); }
+inline vint vround(vfloat a) { return _mm256_cvtps_epi32(a); }
+inline vfloat vtofloat(vint a) { return _mm256_cvtepi32_ps(a); }
+inline vint iand(vint a, int b) { return _mm256_and_si256(a, _mm256_set1_epi32(b)); }
+inline vint iadd(vint a, int b) { return _mm256_add_epi32(a, _mm256_set1_epi32(b)); }
+inline vint ieq(vint a, int b) { return _mm256_cmpeq_epi32(a, _mm256_set1_epi32(b)); }
+inline vint ishl30(vint a) { return _mm256_slli_epi32(a, 30); }
+inline vfloat asfloat(vint a) { return _mm256_castsi256_ps(a); }
+//lanes h*4 .. h*4+3 as an sse register
+inline __m128 half(vfloat a, int h) { return h == 0 ? _mm256_castps256_ps128(a) : _mm256_extractf128_ps(a, 1); }
+#else
+typedef __m128 vfloat;
+typedef __m128i vint;
+const int width = 4;
+inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+inline void vstore(float* p, vfloat a) { _mm_storeu_ps(p, a); }
+inline vfloat vgather(const float* base, const uint32_t* indices) { return _mm_set_ps(base[indices[3]], base[indices[2]], base[indices[1]], base[indices[0]]); }
+inline vfloat vset(float x) { return _mm_set1_ps(x); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+inline vfloat vand(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+inline vfloat vor(vfloat a, vfloat b) { return _mm_or_ps(a, b); }
+inline vfloat vxor(vfloat a, vfloat b) { return _mm_xor_ps(a, b); }
+inline vfloat vabs(vfloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline vfloat vless(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+inline vfloat vselect(vfloat mask, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline int vmovemask(vfloat mask) { return _mm_movemask_ps(mask); }
+inline vint vround(vfloat a) { return _mm_cvtps_epi32(a); }
+inline vfloat vtofloat(vint a) { return _mm_cvtepi32_ps(a); }
+inline vint iand(vint a, int b) { return _mm_and_si128(a, _mm_set1_epi32(b)); }
+inline vint iadd(vint a, int b) { return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+inline vint ieq(vint a, int b) { return _mm_cmpeq_epi32(a, _mm_set1_epi32(b)); }
+inline vint ishl30(vint a) { return _mm_slli_epi32(a, 30); }
+inline vfloat asfloat(vint a) { return _mm_castsi128_ps(a); }
+inline __m128 half(vfloat a, int) { return a; }
+#endif
+
+//sin & cos together: reduce to [-pi/4, pi/4] by quadrant then cephes' minimax polynomials
+inline void vsincos(vfloat x, vfloat& s, vfloat& c)
+{
+	vint quadrant = vround(vmul(x, vset(0.63661977236758134f)));
+	vfloat q = vtofloat(quadrant);
+	//pi/2 split in two so the reduction keeps its precision
+	vfloat r = vsub(vsub(x, vmul(q, vset(1.5707963705062866f))), vmul(q, vset(-4.371139000186e-8f)));
+	vfloat r2 = vmul(r, r);
+
+	vfloat sinPoly = vadd(vmul(vadd(vmul(vset(-1.9515295891e-4f), r2), vset(8.3321608736e-3f)), r2), vset(-1.6666654611e-1f));
+	sinPoly = vadd(vmul(vmul(sinPoly, r2), r), r);
+	vfloat cosPoly = vadd(vmul(vadd(vmul(vset(2.443315711809948e-5f), r2), vset(-1.388731625493765e-3f)), r2), vset(4.166664568298827e-2f));
+	cosPoly = vadd(vsub(vmul(vmul(cosPoly, r2), r2), vmul(vset(0.5f), r2)), vset(1.0f));
+
+	//odd quadrants swap sin & cos, the sign bits come straight from the quadrant number
+	vfloat swap = asfloat(ieq(iand(quadrant, 1), 1));
+	s = vxor(vselect(swap, cosPoly, sinPoly), asfloat(ishl30(iand(quadrant, 2))));
+	c = vxor(vselect(swap, sinPoly, cosPoly), asfloat(ishl30(iand(iadd(quadrant, 1), 2))));
+}
+
+}
+
+#endif
+
+#endif // !SIMD_H
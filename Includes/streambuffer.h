@@ -0,0 +1,41 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <cstddef>
+
+//a buffer rewritten every frame (the instance matrices), with ARB_buffer_storage it's mapped once & split
+//into a ring of frames guarded by fences so writing never waits on the gpu or the driver,
+//otherwise it falls back to orphaning the whole buffer with glMapBufferRange every frame
+class StreamBuffer
+{
+public:
+	//regionBytes is the most one frame writes, persistent asks for the mapped ring (when the driver has it)
+	void create(unsigned int target, size_t regionBytes, bool persistent);
+	void release();
+
+	//where to write this frame's bytes (at most regionBytes), offset is where they start in the buffer
+	//so draws can point at them, nullptr when mapping failed
+	void* map(size_t bytes, size_t& offset);
+	//call once the frame's data is written & before drawing with it
+	void unmap();
+	//call after the draws that read the frame's data, the ring won't hand the region out again until they're done
+	void fence();
+
+	unsigned int id() const { return buffer; }
+	bool persistent() const { return mapping != nullptr; }
+
+	//frames the ring holds, enough for the gpu to be a couple behind the cpu
+	static const unsigned int regionCount = 3;
+
+private:
+	unsigned int target = 0;
+	unsigned int buffer = 0;
+	size_t regionBytes = 0;
+	//the whole ring, mapped for the buffer's lifetime (persistent path only)
+	unsigned char* mapping = nullptr;
+	//the region written last & the fence for each region's last use
+	unsigned int region = regionCount - 1;
+	void* fences[regionCount] = {};
+};
+
+#endif // !STREAMBUFFER_H
@@ -0,0 +1,102 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <lockfreequeue.h>
+#include <textureloader.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+//where an added image ended up, array indexes arrays() & uvScale is the part of the layer the image covers
+//(texture coordinates in [0, 1] times uvScale, anything past 1 samples the padding)
+struct TextureLayer
+{
+	unsigned int array = 0;
+	unsigned int layer = 0;
+	glm::vec2 uvScale = glm::vec2(1.0f);
+};
+
+//how images get fitted into layers
+struct TextureArrayOptions
+{
+	//layers are square powers of 2 between these, an image goes in the smallest size class it fits
+	//& anything bigger than maxSize is scaled down to fit it (keeping its aspect)
+	int minSize = 64;
+	int maxSize = 1024;
+	//stretches every image over its whole layer instead of padding it, uvScale stays 1
+	//so repeat & mirrored wrapping still work (at the cost of resampling every image)
+	bool resample = false;
+	//shared by every layer of an array
+	TextureParams params;
+};
+
+//packs rgba8 images into GL_TEXTURE_2D_ARRAYs, one per size class in use, so a material picks layers
+//instead of binding textures & differently textured objects can share a draw,
+//layers are assigned from the image headers straight away, the decode & fit runs on the pool
+//& the layers are uploaded on the gl thread like TextureLoader (sampling black until then)
+class TextureArrayBuilder
+{
+public:
+	TextureArrayBuilder(ThreadPool& pool, const TextureArrayOptions& options = TextureArrayOptions());
+	~TextureArrayBuilder();
+	//deletes the arrays, call while the context is still alive
+	void release();
+
+	//reads just the image's size & gives it a layer, false when the file isn't an image,
+	//every add has to come before build
+	bool add(const std::string& path, TextureLayer& layer);
+	//creates the arrays & queues every added image's decode, returns straight away
+	void build();
+	//uploads up to maxUploads finished layers, call once a frame on the gl thread
+	void update(unsigned int maxUploads = 4);
+	//blocks (still uploading) until every layer is done
+	void finish();
+	//layers queued but not uploaded yet
+	unsigned int pending() const { return pendingCount; }
+
+	//the gl names, one per size class in the order add first used them
+	const std::vector<unsigned int>& arrays() const { return arrayNames; }
+	//layer size of each array
+	int arraySize(unsigned int array) const { return classes[array].size; }
+
+	//the square size an image of width x height goes in & the width x height it's fitted to
+	static void fitImage(int width, int height, const TextureArrayOptions& options, int& size, int& fittedWidth, int& fittedHeight);
+	//resizes rgba8 pixels, an area average going down & bilinear going up (each axis on its own)
+	static void resample(const unsigned char* source, int sourceWidth, int sourceHeight, unsigned char* destination, int width, int height);
+
+private:
+	//one array's worth of layers
+	struct SizeClass
+	{
+		int size = 0;
+		std::vector<std::string> paths;
+		//layers still to upload, the mips are built once it hits 0
+		unsigned int pending = 0;
+	};
+	//a layer decoded & fitted on a worker, size x size rgba8
+	struct FittedLayer
+	{
+		unsigned int array = 0;
+		unsigned int layer = 0;
+		std::vector<unsigned char> pixels;
+	};
+
+	ThreadPool& pool;
+	TextureArrayOptions options;
+	std::vector<SizeClass> classes;
+	std::vector<unsigned int> arrayNames;
+	LockFreeQueue<FittedLayer> fitted;
+	std::atomic<unsigned int> pendingCount{ 0 };
+
+	void createArray(SizeClass& sizeClass, unsigned int& texture);
+	void upload(FittedLayer& layer);
+	//decodes path & fits it into a size x size layer, false (& a white layer) when it fails to decode
+	static bool fitLayer(const std::string& path, const TextureArrayOptions& options, int size, std::vector<unsigned char>& pixels);
+};
+
+#endif // !TEXTUREARRAY_H
@@ -0,0 +1,78 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <textureloader.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+//how often a texture was already there, had to be loaded & got dropped to stay under the budget
+struct TextureCacheStats
+{
+	unsigned long long hits = 0;
+	unsigned long long misses = 0;
+	unsigned long long evictions = 0;
+	//estimated gpu bytes of every texture in the cache (see UploadedTexture) & the most it held
+	size_t residentBytes = 0;
+	size_t peakBytes = 0;
+};
+
+//hands out the loader's textures by path (& params), each file is loaded once however many times
+//it's asked for, acquire & drop count the references, a texture nothing references stays cached
+//until the budget needs its memory back & then the least recently used ones are deleted first,
+//textures still referenced (or still loading) are never evicted so the budget can be overrun by them
+class TextureCache
+{
+public:
+	TextureCache(TextureLoader& loader, size_t budgetBytes);
+	//deletes every texture, referenced or not, call while the context is still alive
+	void release();
+
+	//the texture for path with these params (the same name every time while it's cached), loading it
+	//the first time, each acquire needs a drop
+	unsigned int acquire(const std::string& path, const TextureParams& params = TextureParams());
+	//gives back a reference, at 0 the texture becomes one the budget can evict
+	void drop(unsigned int texture);
+	//marks the texture used so it's the last to go
+	void touch(unsigned int texture);
+	//picks up the sizes of what the loader uploaded & evicts until under the budget, call once a frame after the loader's update
+	void update();
+
+	void setBudget(size_t bytes) { budget = bytes; }
+	size_t budgetBytes() const { return budget; }
+	size_t count() const { return entries.size(); }
+	const TextureCacheStats& stats() const { return totals; }
+	//one line of the stats above, printed at exit next to the profiler's
+	std::string summary() const;
+
+private:
+	struct Entry
+	{
+		std::string path;
+		unsigned int texture = 0;
+		unsigned int references = 0;
+		size_t bytes = 0;
+		//the loader hasn't uploaded it yet, evicting it would leave a job filling a deleted name
+		bool loading = true;
+		//where it is in recent, the front is the most recently used
+		std::list<uint64_t>::iterator recent;
+	};
+
+	TextureLoader& loader;
+	size_t budget;
+	TextureCacheStats totals;
+	//path & params hash -> texture
+	std::unordered_map<uint64_t, Entry> entries;
+	std::unordered_map<unsigned int, uint64_t> keys;
+	std::list<uint64_t> recent;
+
+	static uint64_t key(const std::string& path, const TextureParams& params);
+	Entry* find(unsigned int texture);
+	void evict();
+	void erase(Entry& entry);
+};
+
+#endif // !TEXTURECACHE_H
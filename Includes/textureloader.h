@@ -0,0 +1,95 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <glad/glad.h>
+#include <lockfreequeue.h>
+#include <bakedtexture.h>
+#include <mipgen.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+//how a texture gets sampled, set on the texture as soon as it's created
+struct TextureParams
+{
+	GLenum wrapS = GL_REPEAT;
+	GLenum wrapT = GL_REPEAT;
+	GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	GLenum magFilter = GL_LINEAR;
+	bool flipVertically = true;
+	//builds the mip chain on the worker (see mipgen.h) & uploads every level as it is,
+	//instead of glGenerateMipmap on the gl thread leaving the filter to the driver
+	bool cpuMips = false;
+	MipFilter mipFilter = MIP_BOX;
+	//the image is srgb colour so the cpu mips are filtered in linear light
+	bool srgb = true;
+};
+
+//an image decoded to rgba8 on a worker, waiting to be uploaded
+struct DecodedImage
+{
+	unsigned int texture = 0;
+	int width = 0;
+	int height = 0;
+	unsigned char* pixels = nullptr; // owned, freed with stbi_image_free
+	//set instead of pixels for a baked (.btex) file, the levels point into its mapping
+	std::unique_ptr<BakedTexture> baked;
+	//levels 1 onwards when the params asked for cpu mips
+	std::vector<MipLevel> mips;
+	std::string path;
+};
+
+//a texture that got its image, with roughly what it takes on the gpu (every level, 0 when it failed)
+struct UploadedTexture
+{
+	unsigned int texture = 0;
+	size_t bytes = 0;
+};
+
+//decodes images on the thread pool & uploads them on the gl thread through a pixel
+//unpack buffer, textures exist (as a 1x1 white placeholder) from the moment load returns,
+//with DSA they're made without binding & get immutable storage at upload (sampling black until then),
+//a .btex path (see bakedtexture.h) is mapped on the worker instead & its compressed levels are
+//uploaded as they are, no decode & no glGenerateMipmap (the flip was done at bake time)
+class TextureLoader
+{
+public:
+	explicit TextureLoader(ThreadPool& pool);
+	~TextureLoader();
+	//deletes the unpack buffer, call while the context is still alive
+	void release();
+
+	//creates the texture & queues the decode, returns straight away
+	unsigned int load(const std::string& path, const TextureParams& params = TextureParams());
+	//uploads up to maxUploads finished images, call once a frame on the gl thread
+	void update(unsigned int maxUploads = 4);
+	//blocks (still uploading) until every queued texture is done
+	void finish();
+	//textures queued but not uploaded yet
+	unsigned int pending() const { return pendingCount; }
+	//the textures update uploaded (or gave up on) since the last call
+	std::vector<UploadedTexture> uploads();
+
+	//reads & decodes one file to rgba8, safe to call from any thread
+	static bool decodeFile(const std::string& path, bool flipVertically, DecodedImage& image);
+	//whether this context can sample a baked format (bc1/bc3 need s3tc, bc7 bptc)
+	static bool bakedFormatSupported(BlockFormat format);
+
+private:
+	ThreadPool& pool;
+	LockFreeQueue<DecodedImage> decoded;
+	std::atomic<unsigned int> pendingCount{ 0 };
+	unsigned int unpackBuffer = 0;
+	std::vector<UploadedTexture> uploaded;
+
+	//both return the bytes the texture ends up taking
+	size_t upload(DecodedImage& image);
+	size_t uploadBaked(DecodedImage& image);
+};
+
+#endif // !TEXTURELOADER_H
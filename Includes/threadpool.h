@@ -0,0 +1,47 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//a fixed set of worker threads pulling jobs off a shared queue
+class ThreadPool
+{
+public:
+	//0 threads means one per hardware thread (minus the caller's)
+	explicit ThreadPool(unsigned int threads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//queues a job to run on some worker
+	void submit(std::function<void()> job);
+	//blocks until every submitted job has finished
+	void wait();
+
+	//splits [0, count) into chunks of about `grain` items and runs fn(begin, end)
+	//on each, the calling thread helps out & it returns once all chunks are done
+	//(without waiting for helpers still queued behind other jobs, so it's safe from inside a job)
+	void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+	unsigned int threadCount() const { return (unsigned int)workers.size(); }
+
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobsDone;
+	size_t running = 0;
+	bool stopping = false;
+
+	void workerLoop();
+};
+
+#endif // !THREADPOOL_H
@@ -0,0 +1,53 @@
+#ifndef TRANSFORMS_H
+#define TRANSFORMS_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+//animated model matrices for lots of objects, stored as structure of arrays.
+//every object is translate(position) * rotate(baseAngle, baseAxis) * rotate(time * spinSpeed, spinAxis),
+//the same chain the render loop used to build with glm per cube
+class TransformSystem
+{
+public:
+	//adds an object and returns its index, angles are in radians
+	size_t add(const glm::vec3& position, const glm::vec3& baseAxis, float baseAngle, const glm::vec3& spinAxis, float spinSpeed);
+	void reserve(size_t count);
+	void clear();
+	size_t size() const { return posX.size(); }
+
+	const glm::vec3 position(size_t i) const { return glm::vec3(posX[i], posY[i], posZ[i]); }
+
+	//writes every model matrix (column major mat4s, so straight into an instance buffer)
+	//using the simd kernel, split across the pool when one is given
+	void computeModels(float time, float* out, ThreadPool* pool = nullptr) const;
+	//computes objects [begin, end) only
+	void computeRange(float time, size_t begin, size_t end, float* out) const;
+	//plain one matrix at a time version, kept as the reference for the simd kernel
+	void computeRangeScalar(float time, size_t begin, size_t end, float* out) const;
+	//only the objects listed in indices (e.g. the ones that survived culling),
+	//packed one after the other into out
+	void computeIndexed(float time, const uint32_t* indices, size_t count, float* out, ThreadPool* pool = nullptr) const;
+
+	//the simd width the kernel was built with (1 when there is none)
+	static int simdWidth();
+
+private:
+	void computeIndexedRange(float time, const uint32_t* indices, size_t begin, size_t end, float* out) const;
+	void computeOneScalar(float time, size_t i, float* model) const;
+	template <typename Load>
+	void computeBlock(float time, Load load, float* model, bool stream) const;
+
+	std::vector<float> posX, posY, posZ;
+	//the constant rotation, stored as a 3x3 matrix (column major, b[column][row])
+	std::vector<float> b00, b01, b02, b10, b11, b12, b20, b21, b22;
+	//normalized spin axis & speed in radians per second
+	std::vector<float> spinX, spinY, spinZ, spinSpeed;
+};
+
+#endif // !TRANSFORMS_H
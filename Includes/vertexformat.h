@@ -0,0 +1,219 @@
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include "glext.h"
+#include "glstate.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+//vertex layouts described once next to the vertex struct, the stride, offsets & gl types all come from
+//the member types at compile time so nothing has to be kept in sync with the glVertexAttribPointer calls
+//
+//	struct CubeVertex { glm::vec3 position; glm::vec2 texCoord; };
+//	VERTEX_ATTRIBUTES(CubeVertex,
+//		VERTEX_ATTRIBUTE(CubeVertex, position, 0),
+//		VERTEX_ATTRIBUTE(CubeVertex, texCoord, 1));
+//	...
+//	setupVertexStreams<CubeVertex>(VAO, { VBO });
+//
+//swapping a member for one of the compact types below (Half4, PackedNormal ...) changes the setup with it
+
+//2 or 4 half floats, the shader still sees vec2/vec4 (or vec3 when it only reads xyz)
+struct Half2 { uint16_t x, y; };
+struct Half4 { uint16_t x, y, z, w; };
+//signed normalized 10:10:10:2, a unit normal or tangent in 4 bytes instead of 12
+struct PackedNormal { uint32_t bits; };
+//4 unsigned normalized bytes, colours & weights
+struct UNorm8x4 { uint8_t x, y, z, w; };
+
+//how the gl sees a member type, columns > 1 is a matrix taking that many consecutive locations
+template <typename T>
+struct AttributeTraits;
+
+#define ATTRIBUTE_TRAITS(Type, Components, GLType, Normalized, Integer, Columns) \
+	template <> struct AttributeTraits<Type> { \
+		static constexpr int components = Components; \
+		static constexpr unsigned int type = GLType; \
+		static constexpr bool normalized = Normalized; \
+		static constexpr bool integer = Integer; \
+		static constexpr unsigned int columns = Columns; \
+	}
+
+ATTRIBUTE_TRAITS(float, 1, GL_FLOAT, false, false, 1);
+ATTRIBUTE_TRAITS(glm::vec2, 2, GL_FLOAT, false, false, 1);
+ATTRIBUTE_TRAITS(glm::vec3, 3, GL_FLOAT, false, false, 1);
+ATTRIBUTE_TRAITS(glm::vec4, 4, GL_FLOAT, false, false, 1);
+ATTRIBUTE_TRAITS(glm::mat4, 4, GL_FLOAT, false, false, 4);
+ATTRIBUTE_TRAITS(Half2, 2, GL_HALF_FLOAT, false, false, 1);
+ATTRIBUTE_TRAITS(Half4, 4, GL_HALF_FLOAT, false, false, 1);
+ATTRIBUTE_TRAITS(PackedNormal, 4, GL_INT_2_10_10_10_REV, true, false, 1);
+ATTRIBUTE_TRAITS(UNorm8x4, 4, GL_UNSIGNED_BYTE, true, false, 1);
+ATTRIBUTE_TRAITS(int32_t, 1, GL_INT, false, true, 1);
+ATTRIBUTE_TRAITS(uint32_t, 1, GL_UNSIGNED_INT, false, true, 1);
+
+#undef ATTRIBUTE_TRAITS
+
+//one attribute of a vertex struct, integer ones go through glVertexAttribIPointer
+struct VertexAttribute
+{
+	unsigned int location;
+	int components;
+	unsigned int type;
+	bool normalized;
+	bool integer;
+	unsigned int columns;
+	unsigned int offset;
+	//bytes the member takes (per column for matrices)
+	unsigned int size;
+};
+
+template <typename T>
+constexpr VertexAttribute vertexAttribute(unsigned int location, size_t offset)
+{
+	using Traits = AttributeTraits<T>;
+	return { location, Traits::components, Traits::type, Traits::normalized, Traits::integer,
+		Traits::columns, (unsigned int)offset, (unsigned int)(sizeof(T) / Traits::columns) };
+}
+
+//the attribute list of a vertex struct, specialized by VERTEX_ATTRIBUTES / INSTANCE_ATTRIBUTES
+template <typename Vertex>
+struct VertexAttributes;
+
+#define VERTEX_ATTRIBUTE(Vertex, member, location) vertexAttribute<decltype(Vertex::member)>(location, offsetof(Vertex, member))
+
+#define VERTEX_STREAM(Vertex, Divisor, ...) \
+	template <> struct VertexAttributes<Vertex> { \
+		static constexpr VertexAttribute list[] = { __VA_ARGS__ }; \
+		static constexpr size_t count = sizeof(list) / sizeof(list[0]); \
+		static constexpr unsigned int stride = sizeof(Vertex); \
+		static constexpr unsigned int divisor = Divisor; \
+	}
+//per vertex data
+#define VERTEX_ATTRIBUTES(Vertex, ...) VERTEX_STREAM(Vertex, 0, __VA_ARGS__)
+//per instance data, steps once per instance instead of once per vertex
+#define INSTANCE_ATTRIBUTES(Vertex, ...) VERTEX_STREAM(Vertex, 1, __VA_ARGS__)
+
+//every attribute fits inside the stride & none of them overlap
+template <typename Vertex>
+constexpr bool validVertexLayout()
+{
+	using Layout = VertexAttributes<Vertex>;
+	for (size_t i = 0; i < Layout::count; i++) {
+		const VertexAttribute& a = Layout::list[i];
+		unsigned int end = a.offset + a.size * a.columns;
+		if (end > Layout::stride)
+			return false;
+		for (size_t j = i + 1; j < Layout::count; j++) {
+			const VertexAttribute& b = Layout::list[j];
+			if (a.offset < b.offset + b.size * b.columns && b.offset < end)
+				return false;
+			if (a.location < b.location + b.columns && b.location < a.location + a.columns)
+				return false;
+		}
+	}
+	return true;
+}
+
+//points the attributes of one stream at buffer, with DSA the stream gets its own binding point
+//& nothing is bound, otherwise the vao is bound & it's glVertexAttribPointer
+template <typename Vertex>
+void setupVertexStream(unsigned int vertexArray, unsigned int binding, unsigned int buffer)
+{
+	using Layout = VertexAttributes<Vertex>;
+	static_assert(validVertexLayout<Vertex>(), "vertex attributes overlap or run past the end of the vertex");
+
+	if (glext.directStateAccess) {
+		glext.VertexArrayVertexBuffer(vertexArray, binding, buffer, 0, Layout::stride);
+		glext.VertexArrayBindingDivisor(vertexArray, binding, Layout::divisor);
+		for (const VertexAttribute& attribute : Layout::list) {
+			for (unsigned int column = 0; column < attribute.columns; column++) {
+				unsigned int location = attribute.location + column;
+				unsigned int offset = attribute.offset + column * attribute.size;
+				if (attribute.integer)
+					glext.VertexArrayAttribIFormat(vertexArray, location, attribute.components, attribute.type, offset);
+				else
+					glext.VertexArrayAttribFormat(vertexArray, location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE, offset);
+				glext.VertexArrayAttribBinding(vertexArray, location, binding);
+				glext.EnableVertexArrayAttrib(vertexArray, location);
+			}
+		}
+		return;
+	}
+
+	glstate.bindVertexArray(vertexArray);
+	glstate.bindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (const VertexAttribute& attribute : Layout::list) {
+		for (unsigned int column = 0; column < attribute.columns; column++) {
+			unsigned int location = attribute.location + column;
+			const void* offset = (const void*)(uintptr_t)(attribute.offset + column * attribute.size);
+			if (attribute.integer)
+				glVertexAttribIPointer(location, attribute.components, attribute.type, Layout::stride, offset);
+			else
+				glVertexAttribPointer(location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE, Layout::stride, offset);
+			glEnableVertexAttribArray(location);
+			if (Layout::divisor)
+				glVertexAttribDivisor(location, Layout::divisor);
+		}
+	}
+}
+
+//sets up vertexArray from one buffer per stream struct, a single struct is an interleaved layout
+//& several (positions in one buffer, uvs in another ...) are split streams, each on its own binding
+//(so every stream of a vao has to be set up in the one call)
+template <typename... Streams>
+void setupVertexStreams(unsigned int vertexArray, const unsigned int (&buffers)[sizeof...(Streams)])
+{
+	unsigned int stream = 0;
+	((setupVertexStream<Streams>(vertexArray, stream, buffers[stream]), stream++), ...);
+}
+
+//float -> half float, rounds to nearest & flushes what's too small for a half to 0
+inline uint16_t packHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	if (((bits >> 23) & 0xFF) == 0xFF) // inf & nan
+		return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+	if (exponent <= 0)
+		return (uint16_t)sign;
+	if (exponent >= 31)
+		return (uint16_t)(sign | 0x7C00);
+	uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+	//round half to even on the dropped bits, a carry into the exponent is still the right answer
+	uint32_t dropped = mantissa & 0x1FFF;
+	if (dropped > 0x1000 || (dropped == 0x1000 && (half & 1)))
+		half++;
+	return (uint16_t)half;
+}
+
+inline Half2 packHalf2(const glm::vec2& v)
+{
+	return { packHalf(v.x), packHalf(v.y) };
+}
+inline Half4 packHalf4(const glm::vec4& v)
+{
+	return { packHalf(v.x), packHalf(v.y), packHalf(v.z), packHalf(v.w) };
+}
+
+//xyz in [-1, 1] to 10 bits each, w to the top 2
+inline PackedNormal packNormal(const glm::vec4& v)
+{
+	auto snorm = [](float f, float scale, uint32_t mask) {
+		f = f < -1.0f ? -1.0f : (f > 1.0f ? 1.0f : f);
+		float scaled = f * scale;
+		return (uint32_t)(int32_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f) & mask;
+	};
+	return { snorm(v.x, 511.0f, 0x3FF) | (snorm(v.y, 511.0f, 0x3FF) << 10)
+		| (snorm(v.z, 511.0f, 0x3FF) << 20) | (snorm(v.w, 1.0f, 0x3) << 30) };
+}
+
+#endif // !VERTEXFORMAT_H
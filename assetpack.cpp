@@ -0,0 +1,191 @@
+#include "assetpack.h"
+#include "hash.h"
+#include "lzblock.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+AssetPack assetPack;
+
+bool AssetPack::open(const std::string& path, const std::string& root)
+{
+	close();
+	if (!file.open(path)) {
+		std::cout << "ERROR::ASSETPACK::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+		return false;
+	}
+	auto fail = [&](const char* why) {
+		std::cout << "ERROR::ASSETPACK::" << why << " " << path << std::endl;
+		close();
+		return false;
+	};
+
+	AssetPackHeader header;
+	if (file.size() < sizeof(header))
+		return fail("TRUNCATED");
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (std::memcmp(header.identifier, assetPackIdentifier, sizeof(assetPackIdentifier)) != 0)
+		return fail("NOT_AN_ASSET_PACK");
+	size_t tableEnd = sizeof(header) + (size_t)header.entryCount * sizeof(AssetPackEntry);
+	if (file.size() < tableEnd || header.namesOffset < tableEnd || header.namesOffset > file.size() || header.namesSize > file.size() - header.namesOffset)
+		return fail("TRUNCATED");
+
+	//the mapping is page aligned & the table starts 32 bytes in, so it's read in place
+	const AssetPackEntry* table = (const AssetPackEntry*)(file.data() + sizeof(header));
+	for (uint32_t i = 0; i < header.entryCount; i++) {
+		const AssetPackEntry& entry = table[i];
+		bool compressed = (entry.flags & ASSET_COMPRESSED) != 0;
+		if (entry.offset > file.size() || entry.storedSize > file.size() - entry.offset
+			|| (!compressed && entry.storedSize != entry.size)
+			|| (uint64_t)entry.nameOffset + entry.nameLength > header.namesSize
+			|| (i > 0 && table[i - 1].hash > entry.hash))
+			return fail("BAD_ENTRY");
+	}
+	entries = table;
+	entryCount = header.entryCount;
+	names = file.data() + header.namesOffset;
+	rootPath = std::filesystem::path(root).lexically_normal().generic_string();
+	return true;
+}
+
+void AssetPack::close()
+{
+	file.close();
+	entries = nullptr;
+	entryCount = 0;
+	names = nullptr;
+	rootPath.clear();
+}
+
+std::string AssetPack::name(const std::string& path) const
+{
+	std::filesystem::path normal = std::filesystem::path(path).lexically_normal();
+	if (!normal.is_absolute())
+		return normal.generic_string();
+	std::filesystem::path relative = normal.lexically_relative(rootPath);
+	//outside the root, it can't be in the pack but the lookup can still just miss
+	return relative.empty() ? normal.generic_string() : relative.generic_string();
+}
+
+const AssetPackEntry* AssetPack::find(const std::string& path) const
+{
+	if (!entries)
+		return nullptr;
+	std::string key = name(path);
+	uint64_t hash = hashString(key);
+	const AssetPackEntry* end = entries + entryCount;
+	const AssetPackEntry* entry = std::lower_bound(entries, end, hash, [](const AssetPackEntry& e, uint64_t h) { return e.hash < h; });
+	//colliding hashes sit next to each other, the path settles it
+	for (; entry != end && entry->hash == hash; entry++)
+		if (entry->nameLength == key.size() && std::memcmp(names + entry->nameOffset, key.data(), key.size()) == 0)
+			return entry;
+	return nullptr;
+}
+
+bool AssetPack::contains(const std::string& path) const
+{
+	return find(path) != nullptr;
+}
+
+bool AssetPack::load(const std::string& path, AssetSpan& span) const
+{
+	const AssetPackEntry* entry = find(path);
+	if (!entry)
+		return false;
+	const unsigned char* stored = (const unsigned char*)file.data() + entry->offset;
+	span.owned.clear();
+	if (!(entry->flags & ASSET_COMPRESSED)) {
+		span.data = stored;
+		span.size = (size_t)entry->size;
+		return true;
+	}
+	span.owned.resize((size_t)entry->size);
+	if (!lzDecompress(stored, (size_t)entry->storedSize, span.owned.data(), span.owned.size())) {
+		std::cout << "ERROR::ASSETPACK::BAD_BLOB " << path << std::endl;
+		span.owned.clear();
+		return false;
+	}
+	span.data = span.owned.data();
+	span.size = span.owned.size();
+	return true;
+}
+
+std::vector<std::string> AssetPack::paths() const
+{
+	std::vector<std::string> result;
+	for (size_t i = 0; i < entryCount; i++)
+		result.emplace_back(names + entries[i].nameOffset, entries[i].nameLength);
+	return result;
+}
+
+bool writeAssetPack(const std::string& path, const std::vector<AssetPackInput>& files)
+{
+	//compressed where it pays, then the table sorted by hash
+	std::vector<std::vector<unsigned char>> blobs(files.size());
+	std::vector<AssetPackEntry> table(files.size());
+	std::string names;
+	for (size_t i = 0; i < files.size(); i++) {
+		AssetPackEntry& entry = table[i];
+		entry = {};
+		entry.hash = hashString(files[i].name);
+		entry.size = files[i].data.size();
+		entry.nameOffset = (uint32_t)names.size();
+		entry.nameLength = (uint32_t)files[i].name.size();
+		names += files[i].name;
+		if (files[i].compress && !files[i].data.empty()) {
+			std::vector<unsigned char> packed(lzCompressBound(files[i].data.size()));
+			size_t packedSize = lzCompress(files[i].data.data(), files[i].data.size(), packed.data(), packed.size());
+			if (packedSize > 0 && packedSize <= files[i].data.size() - files[i].data.size() / 8) {
+				packed.resize(packedSize);
+				blobs[i].swap(packed);
+				entry.flags |= ASSET_COMPRESSED;
+			}
+		}
+		entry.storedSize = (entry.flags & ASSET_COMPRESSED) ? blobs[i].size() : entry.size;
+		//which blob it is until the offsets get worked out
+		entry.offset = i;
+	}
+	std::sort(table.begin(), table.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.hash < b.hash; });
+
+	AssetPackHeader header = {};
+	std::memcpy(header.identifier, assetPackIdentifier, sizeof(header.identifier));
+	header.entryCount = (uint32_t)table.size();
+	header.namesOffset = sizeof(header) + table.size() * sizeof(AssetPackEntry);
+	header.namesSize = names.size();
+
+	//blobs in table order, each on its own page
+	std::vector<size_t> order(table.size());
+	size_t offset = (size_t)(header.namesOffset + header.namesSize);
+	for (size_t i = 0; i < table.size(); i++) {
+		order[i] = (size_t)table[i].offset;
+		offset = (offset + assetPackAlignment - 1) / assetPackAlignment * assetPackAlignment;
+		table[i].offset = offset;
+		offset += (size_t)table[i].storedSize;
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		std::cout << "ERROR::ASSETPACK::FILE_NOT_WRITTEN " << path << std::endl;
+		return false;
+	}
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)table.data(), table.size() * sizeof(AssetPackEntry));
+	file.write(names.data(), names.size());
+	size_t written = (size_t)(header.namesOffset + header.namesSize);
+	const char padding[assetPackAlignment] = {};
+	for (size_t i = 0; i < table.size(); i++) {
+		const AssetPackEntry& entry = table[i];
+		const std::vector<unsigned char>& data = (entry.flags & ASSET_COMPRESSED) ? blobs[order[i]] : files[order[i]].data;
+		file.write(padding, (std::streamsize)(entry.offset - written));
+		file.write((const char*)data.data(), (std::streamsize)data.size());
+		written = (size_t)(entry.offset + entry.storedSize);
+	}
+	if (!file) {
+		std::cout << "ERROR::ASSETPACK::FILE_NOT_WRITTEN " << path << std::endl;
+		return false;
+	}
+	return true;
+}
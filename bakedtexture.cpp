@@ -0,0 +1,147 @@
+#include "bakedtexture.h"
+#include "glext.h"
+#include "assetpack.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+//level data starts on this, a whole number of blocks for every format
+static const size_t levelAlignment = 16;
+
+bool BakedTexture::open(const std::string& path)
+{
+	levelViews.clear();
+	file.close();
+	const char* data;
+	size_t size;
+	if (assetPack.load(path, packed)) {
+		data = (const char*)packed.data;
+		size = packed.size;
+	}
+	else if (file.open(path)) {
+		data = file.data();
+		size = file.size();
+	}
+	else {
+		std::cout << "ERROR::BAKEDTEXTURE::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+		return false;
+	}
+	auto fail = [&](const char* why) {
+		std::cout << "ERROR::BAKEDTEXTURE::" << why << " " << path << std::endl;
+		file.close();
+		packed = AssetSpan();
+		return false;
+	};
+
+	if (size < sizeof(BakedTextureHeader))
+		return fail("TRUNCATED");
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.identifier, bakedTextureIdentifier, sizeof(bakedTextureIdentifier)) != 0)
+		return fail("NOT_A_BAKED_TEXTURE");
+	if (header.format >= BLOCK_FORMAT_COUNT || header.width == 0 || header.height == 0 || header.levelCount == 0 || header.levelCount > 32)
+		return fail("BAD_HEADER");
+	size_t indexEnd = sizeof(header) + header.levelCount * sizeof(BakedLevelIndex);
+	if (size < indexEnd)
+		return fail("TRUNCATED");
+
+	const BakedLevelIndex* index = (const BakedLevelIndex*)(data + sizeof(header));
+	int width = (int)header.width, height = (int)header.height;
+	for (uint32_t level = 0; level < header.levelCount; level++) {
+		BakedLevel view;
+		view.width = width;
+		view.height = height;
+		view.size = (size_t)index[level].size;
+		if (index[level].offset < indexEnd || index[level].offset > size || view.size > size - index[level].offset
+			|| view.size != compressedSize(format(), width, height))
+			return fail("BAD_LEVEL");
+		view.data = (const unsigned char*)data + index[level].offset;
+		levelViews.push_back(view);
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return true;
+}
+
+void BakedTexture::prefetch() const
+{
+	//one read a page, volatile so it isn't thrown away
+	volatile unsigned char sink = 0;
+	for (const BakedLevel& level : levelViews)
+		for (size_t offset = 0; offset < level.size; offset += 4096)
+			sink += level.data[offset];
+	(void)sink;
+}
+
+unsigned int BakedTexture::glFormat(BlockFormat format)
+{
+	switch (format) {
+	case BLOCK_BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case BLOCK_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case BLOCK_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	default: return 0;
+	}
+}
+
+bool BakedTexture::peekFormat(const std::string& path, BlockFormat& format)
+{
+	BakedTextureHeader header;
+	AssetSpan packed;
+	if (assetPack.load(path, packed)) {
+		if (packed.size < sizeof(header))
+			return false;
+		std::memcpy(&header, packed.data, sizeof(header));
+	}
+	else {
+		std::ifstream file(path, std::ios::binary);
+		if (!file.read((char*)&header, sizeof(header)))
+			return false;
+	}
+	if (std::memcmp(header.identifier, bakedTextureIdentifier, sizeof(bakedTextureIdentifier)) != 0 || header.format >= BLOCK_FORMAT_COUNT)
+		return false;
+	format = (BlockFormat)header.format;
+	return true;
+}
+
+bool writeBakedTexture(const std::string& path, BlockFormat format, uint32_t flags, const std::vector<BakedLevel>& levels)
+{
+	if (levels.empty())
+		return false;
+	BakedTextureHeader header = {};
+	std::memcpy(header.identifier, bakedTextureIdentifier, sizeof(header.identifier));
+	header.format = format;
+	header.width = (uint32_t)levels[0].width;
+	header.height = (uint32_t)levels[0].height;
+	header.levelCount = (uint32_t)levels.size();
+	header.flags = flags;
+
+	//smallest level first in the file, like ktx2, so a reader streaming it in gets something to show soonest
+	std::vector<BakedLevelIndex> index(levels.size());
+	size_t offset = sizeof(header) + index.size() * sizeof(BakedLevelIndex);
+	for (size_t level = levels.size(); level-- > 0;) {
+		offset = (offset + levelAlignment - 1) / levelAlignment * levelAlignment;
+		index[level].offset = offset;
+		index[level].size = levels[level].size;
+		offset += levels[level].size;
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		std::cout << "ERROR::BAKEDTEXTURE::FILE_NOT_WRITTEN " << path << std::endl;
+		return false;
+	}
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)index.data(), index.size() * sizeof(BakedLevelIndex));
+	size_t written = sizeof(header) + index.size() * sizeof(BakedLevelIndex);
+	const char padding[levelAlignment] = {};
+	for (size_t level = levels.size(); level-- > 0;) {
+		file.write(padding, index[level].offset - written);
+		file.write((const char*)levels[level].data, levels[level].size);
+		written = index[level].offset + levels[level].size;
+	}
+	if (!file) {
+		std::cout << "ERROR::BAKEDTEXTURE::FILE_NOT_WRITTEN " << path << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,423 @@
+#include "bcencoder.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+size_t blockBytes(BlockFormat format)
+{
+	return format == BLOCK_BC1 ? 8 : 16;
+}
+
+const char* blockFormatName(BlockFormat format)
+{
+	switch (format) {
+	case BLOCK_BC1: return "bc1";
+	case BLOCK_BC3: return "bc3";
+	case BLOCK_BC7: return "bc7";
+	default: return nullptr;
+	}
+}
+
+size_t compressedSize(BlockFormat format, int width, int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+//the direction the texels spread out along the most, power iteration on their covariance
+//(channels is 3 for bc1 colour & 4 for bc7), all 0 when every texel is the same
+static void principalAxis(const float (*texels)[4], int count, int channels, float* mean, float* axis)
+{
+	for (int c = 0; c < 4; c++)
+		mean[c] = axis[c] = 0.0f;
+	for (int i = 0; i < count; i++)
+		for (int c = 0; c < channels; c++)
+			mean[c] += texels[i][c];
+	for (int c = 0; c < channels; c++)
+		mean[c] /= count;
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < count; i++) {
+		float d[4];
+		for (int c = 0; c < channels; c++)
+			d[c] = texels[i][c] - mean[c];
+		for (int a = 0; a < channels; a++)
+			for (int b = 0; b < channels; b++)
+				covariance[a][b] += d[a] * d[b];
+	}
+
+	//starts from the channel that varies the most so it can't begin at right angles to the answer
+	int widest = 0;
+	for (int c = 1; c < channels; c++)
+		if (covariance[c][c] > covariance[widest][widest])
+			widest = c;
+	for (int c = 0; c < channels; c++)
+		axis[c] = covariance[widest][c];
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = {};
+		for (int a = 0; a < channels; a++)
+			for (int b = 0; b < channels; b++)
+				next[a] += covariance[a][b] * axis[b];
+		float length = 0.0f;
+		for (int c = 0; c < channels; c++)
+			length += next[c] * next[c];
+		if (length < 1e-12f)
+			break;
+		length = 1.0f / std::sqrt(length);
+		for (int c = 0; c < channels; c++)
+			axis[c] = next[c] * length;
+	}
+}
+
+//the endpoints along axis covering the texels, pulled in by a fraction of the range
+//(the ends are usually better served by the interpolated entries than the endpoints themselves)
+static void axisEndpoints(const float (*texels)[4], int count, int channels, const float* mean, const float* axis, float inset, float* low, float* high)
+{
+	float minT = 0.0f, maxT = 0.0f;
+	for (int i = 0; i < count; i++) {
+		float t = 0.0f;
+		for (int c = 0; c < channels; c++)
+			t += (texels[i][c] - mean[c]) * axis[c];
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+	float pull = (maxT - minT) * inset;
+	minT += pull;
+	maxT -= pull;
+	for (int c = 0; c < channels; c++) {
+		low[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * minT));
+		high[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * maxT));
+	}
+}
+
+//least squares endpoints for texels already assigned palette entries, entry k of texel i is
+//weights[k] * first + (1 - weights[k]) * second, false when they can't be solved (everything on one entry)
+static bool refitEndpoints(const float (*texels)[4], const int* entries, int count, int channels, const float* weights, float* first, float* second)
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[4] = {}, bx[4] = {};
+	for (int i = 0; i < count; i++) {
+		float a = weights[entries[i]];
+		float b = 1.0f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < channels; c++) {
+			ax[c] += a * texels[i][c];
+			bx[c] += b * texels[i][c];
+		}
+	}
+	float determinant = aa * bb - ab * ab;
+	if (std::fabs(determinant) < 1e-6f)
+		return false;
+	for (int c = 0; c < channels; c++) {
+		first[c] = std::min(255.0f, std::max(0.0f, (bb * ax[c] - ab * bx[c]) / determinant));
+		second[c] = std::min(255.0f, std::max(0.0f, (aa * bx[c] - ab * ax[c]) / determinant));
+	}
+	return true;
+}
+
+static uint16_t pack565(const float* color)
+{
+	int r = std::min(31, std::max(0, (int)(color[0] * 31.0f / 255.0f + 0.5f)));
+	int g = std::min(63, std::max(0, (int)(color[1] * 63.0f / 255.0f + 0.5f)));
+	int b = std::min(31, std::max(0, (int)(color[2] * 31.0f / 255.0f + 0.5f)));
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpack565(uint16_t packed, int* color)
+{
+	int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+//the colour half of bc1/bc3, threeColor picks the mode with a transparent entry (c0 <= c1),
+//puts the endpoints in the order their mode needs & picks every texel's entry, returns the squared error
+static float colorIndices(uint16_t& c0, uint16_t& c1, const float (*texels)[4], const bool* transparent, bool threeColor, int* entries, uint32_t& indices)
+{
+	if (threeColor ? c0 > c1 : c0 < c1)
+		std::swap(c0, c1);
+	int palette[4][3];
+	unpack565(c0, palette[0]);
+	unpack565(c1, palette[1]);
+	int colors = 3;
+	for (int c = 0; c < 3; c++) {
+		if (c0 > c1) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			colors = 4;
+		}
+		else {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+		}
+	}
+
+	float error = 0.0f;
+	indices = 0;
+	for (int i = 0, opaque = 0; i < 16; i++) {
+		if (transparent[i]) {
+			indices |= 3u << (2 * i);
+			continue;
+		}
+		const float* texel = texels[opaque];
+		int best = 0;
+		float bestError = 1e30f;
+		for (int k = 0; k < colors; k++) {
+			float d0 = texel[0] - palette[k][0], d1 = texel[1] - palette[k][1], d2 = texel[2] - palette[k][2];
+			float d = d0 * d0 + d1 * d1 + d2 * d2;
+			if (d < bestError) {
+				bestError = d;
+				best = k;
+			}
+		}
+		entries[opaque++] = best;
+		error += bestError;
+		indices |= (uint32_t)best << (2 * i);
+	}
+	return error;
+}
+
+//bc1 colour block, punchThrough lets texels under half alpha go fully transparent (bc1 proper)
+//& bc3 leaves it off since its alpha has its own block
+static void encodeColor(const uint8_t* rgba, bool punchThrough, uint8_t* out)
+{
+	float texels[16][4];
+	bool transparent[16];
+	int count = 0;
+	for (int i = 0; i < 16; i++) {
+		transparent[i] = punchThrough && rgba[i * 4 + 3] < 128;
+		if (transparent[i])
+			continue;
+		for (int c = 0; c < 3; c++)
+			texels[count][c] = rgba[i * 4 + c];
+		count++;
+	}
+
+	uint16_t c0 = 0, c1 = 0;
+	uint32_t indices = 0xFFFFFFFF; // all transparent
+	if (count > 0) {
+		bool threeColor = count < 16;
+		float mean[4], axis[4], low[4], high[4];
+		principalAxis(texels, count, 3, mean, axis);
+		axisEndpoints(texels, count, 3, mean, axis, 1.0f / 16.0f, low, high);
+		c0 = pack565(high);
+		c1 = pack565(low);
+		int entries[16];
+		float error = colorIndices(c0, c1, texels, transparent, threeColor, entries, indices);
+
+		//one least squares pass over the chosen entries, kept if it's closer
+		static const float fourColorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		static const float threeColorWeights[3] = { 1.0f, 0.0f, 0.5f };
+		float first[4], second[4];
+		if (refitEndpoints(texels, entries, count, 3, c0 > c1 ? fourColorWeights : threeColorWeights, first, second)) {
+			uint16_t r0 = pack565(first), r1 = pack565(second);
+			uint32_t refitIndices;
+			int refitEntries[16];
+			if (colorIndices(r0, r1, texels, transparent, threeColor, refitEntries, refitIndices) < error) {
+				c0 = r0;
+				c1 = r1;
+				indices = refitIndices;
+			}
+		}
+	}
+
+	out[0] = (uint8_t)c0;
+	out[1] = (uint8_t)(c0 >> 8);
+	out[2] = (uint8_t)c1;
+	out[3] = (uint8_t)(c1 >> 8);
+	for (int b = 0; b < 4; b++)
+		out[4 + b] = (uint8_t)(indices >> (8 * b));
+}
+
+//bc3's alpha block, the 8 entry mode between the block's lowest & highest alpha
+static void encodeAlpha(const uint8_t* rgba, uint8_t* out)
+{
+	int low = 255, high = 0;
+	for (int i = 0; i < 16; i++) {
+		low = std::min(low, (int)rgba[i * 4 + 3]);
+		high = std::max(high, (int)rgba[i * 4 + 3]);
+	}
+	out[0] = (uint8_t)high;
+	out[1] = (uint8_t)low;
+	std::memset(out + 2, 0, 6);
+	if (high == low)
+		return;
+
+	int palette[8] = { high, low };
+	for (int k = 2; k < 8; k++)
+		palette[k] = ((8 - k) * high + (k - 1) * low) / 7;
+	uint64_t bits = 0;
+	for (int i = 0; i < 16; i++) {
+		int alpha = rgba[i * 4 + 3];
+		int best = 0;
+		for (int k = 1; k < 8; k++)
+			if (std::abs(alpha - palette[k]) < std::abs(alpha - palette[best]))
+				best = k;
+		bits |= (uint64_t)best << (3 * i);
+	}
+	for (int b = 0; b < 6; b++)
+		out[2 + b] = (uint8_t)(bits >> (8 * b));
+}
+
+void encodeBC1Block(const uint8_t* rgba, uint8_t* out)
+{
+	encodeColor(rgba, true, out);
+}
+
+void encodeBC3Block(const uint8_t* rgba, uint8_t* out)
+{
+	encodeAlpha(rgba, out);
+	encodeColor(rgba, false, out + 8);
+}
+
+//bc7 mode 6: one subset, rgba endpoints of 7 bits plus a p bit each (8 bit value = q << 1 | p)
+//& a 4 bit index per texel, the best single mode for smooth opaque or alpha blocks
+namespace {
+struct Mode6Endpoints
+{
+	int q[2][4];
+	int p[2];
+};
+}
+
+static const int bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+//the 7 bit endpoint & p bit that land closest to value
+static void quantizeMode6(const float* value, int* q, int& p)
+{
+	float bestError = 1e30f;
+	for (int bit = 0; bit < 2; bit++) {
+		int candidate[4];
+		float error = 0.0f;
+		for (int c = 0; c < 4; c++) {
+			candidate[c] = std::min(127, std::max(0, (int)((value[c] - bit) / 2.0f + 0.5f)));
+			float d = (float)((candidate[c] << 1) | bit) - value[c];
+			error += d * d;
+		}
+		if (error < bestError) {
+			bestError = error;
+			std::memcpy(q, candidate, sizeof(candidate));
+			p = bit;
+		}
+	}
+}
+
+static float mode6Indices(const Mode6Endpoints& endpoints, const float (*texels)[4], int* entries)
+{
+	int palette[16][4];
+	for (int c = 0; c < 4; c++) {
+		int e0 = (endpoints.q[0][c] << 1) | endpoints.p[0];
+		int e1 = (endpoints.q[1][c] << 1) | endpoints.p[1];
+		for (int k = 0; k < 16; k++)
+			palette[k][c] = ((64 - bc7Weights4[k]) * e0 + bc7Weights4[k] * e1 + 32) >> 6;
+	}
+	float error = 0.0f;
+	for (int i = 0; i < 16; i++) {
+		float bestError = 1e30f;
+		for (int k = 0; k < 16; k++) {
+			float d = 0.0f;
+			for (int c = 0; c < 4; c++) {
+				float diff = texels[i][c] - palette[k][c];
+				d += diff * diff;
+			}
+			if (d < bestError) {
+				bestError = d;
+				entries[i] = k;
+			}
+		}
+		error += bestError;
+	}
+	return error;
+}
+
+void encodeBC7Block(const uint8_t* rgba, uint8_t* out)
+{
+	float texels[16][4];
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 4; c++)
+			texels[i][c] = rgba[i * 4 + c];
+
+	float mean[4], axis[4], low[4], high[4];
+	principalAxis(texels, 16, 4, mean, axis);
+	axisEndpoints(texels, 16, 4, mean, axis, 1.0f / 64.0f, low, high);
+	Mode6Endpoints best;
+	quantizeMode6(low, best.q[0], best.p[0]);
+	quantizeMode6(high, best.q[1], best.p[1]);
+	int entries[16];
+	float error = mode6Indices(best, texels, entries);
+
+	//one least squares pass, entry k is (64 - w) / 64 of the first endpoint
+	float weights[16];
+	for (int k = 0; k < 16; k++)
+		weights[k] = (64 - bc7Weights4[k]) / 64.0f;
+	float first[4], second[4];
+	if (refitEndpoints(texels, entries, 16, 4, weights, first, second)) {
+		Mode6Endpoints refit;
+		quantizeMode6(first, refit.q[0], refit.p[0]);
+		quantizeMode6(second, refit.q[1], refit.p[1]);
+		int refitEntries[16];
+		float refitError = mode6Indices(refit, texels, refitEntries);
+		if (refitError < error) {
+			best = refit;
+			std::memcpy(entries, refitEntries, sizeof(entries));
+		}
+	}
+
+	//the first texel's index is stored without its top bit (it has to be 0),
+	//so the endpoints swap ends when it'd need it
+	if (entries[0] >= 8) {
+		std::swap(best.q[0], best.q[1]);
+		std::swap(best.p[0], best.p[1]);
+		for (int& entry : entries)
+			entry = 15 - entry;
+	}
+
+	std::memset(out, 0, 16);
+	int bit = 0;
+	auto write = [&](uint32_t value, int bits) {
+		for (int i = 0; i < bits; i++, bit++)
+			if ((value >> i) & 1)
+				out[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+	};
+	write(1 << 6, 7); // mode 6
+	for (int c = 0; c < 4; c++) {
+		write(best.q[0][c], 7);
+		write(best.q[1][c], 7);
+	}
+	write(best.p[0], 1);
+	write(best.p[1], 1);
+	write(entries[0], 3);
+	for (int i = 1; i < 16; i++)
+		write(entries[i], 4);
+}
+
+void compressImage(BlockFormat format, const uint8_t* rgba, int width, int height, uint8_t* out, ThreadPool* pool)
+{
+	void (*encode)(const uint8_t*, uint8_t*) = format == BLOCK_BC1 ? encodeBC1Block : (format == BLOCK_BC3 ? encodeBC3Block : encodeBC7Block);
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+	size_t bytes = blockBytes(format);
+
+	auto encodeRows = [&](size_t begin, size_t end) {
+		uint8_t block[64];
+		for (size_t by = begin; by < end; by++) {
+			for (int bx = 0; bx < blocksX; bx++) {
+				for (int y = 0; y < 4; y++) {
+					int sy = std::min((int)by * 4 + y, height - 1);
+					for (int x = 0; x < 4; x++) {
+						int sx = std::min(bx * 4 + x, width - 1);
+						std::memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+					}
+				}
+				encode(block, out + (by * blocksX + bx) * bytes);
+			}
+		}
+	};
+	if (pool)
+		pool->parallelFor(blocksY, 4, encodeRows);
+	else
+		encodeRows(0, blocksY);
+}
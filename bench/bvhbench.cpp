@@ -0,0 +1,110 @@
+//bvh build & query times against the flat culling/brute force paths at 10k, 100k & 1M objects
+//  ./bin/bvhbench [iterations]
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <bvh.h>
+#include <culling.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+template <typename Fn>
+static double measure(int iterations, Fn fn)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		fn();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+//closest box along the ray by testing every one, what the bvh has to agree with
+static bool raycastBruteForce(const BoxSet& boxes, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t& hit)
+{
+	glm::vec3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	float best = maxDistance;
+	bool found = false;
+	for (size_t i = 0; i < boxes.size(); i++) {
+		glm::vec3 center(boxes.x[i], boxes.y[i], boxes.z[i]);
+		glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+		glm::vec3 t1 = (center - extent - origin) * inverse;
+		glm::vec3 t2 = (center + extent - origin) * inverse;
+		float tmin = std::max(0.0f, std::max(std::min(t1.x, t2.x), std::max(std::min(t1.y, t2.y), std::min(t1.z, t2.z))));
+		float tmax = std::min(best, std::min(std::max(t1.x, t2.x), std::min(std::max(t1.y, t2.y), std::max(t1.z, t2.z))));
+		if (tmin <= tmax && tmin < best) {
+			best = tmin;
+			hit = (uint32_t)i;
+			found = true;
+		}
+	}
+	return found;
+}
+
+static void run(size_t count, int iterations)
+{
+	//same layout as the cube scene, a box in front of the camera that grows with the count
+	float spread = 4.0f * std::cbrt((float)count / 10.0f);
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> xy(-spread, spread);
+	std::uniform_real_distribution<float> z(-4.0f * spread, 0.0f);
+	BoxSet boxes;
+	for (size_t i = 0; i < count; i++)
+		boxes.add(glm::vec3(xy(rng), xy(rng), z(rng)), glm::vec3(0.8660254f));
+
+	glm::vec3 eye(0.0f, 0.0f, 3.0f);
+	glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+	Frustum frustum = Frustum::fromMatrix(projection * view);
+
+	Bvh bvh;
+	double buildMs = measure(1, [&] { bvh.build(boxes); });
+	std::cout << count << " objects: build " << buildMs << " ms, " << bvh.nodeCount() << " nodes, depth " << bvh.depth() << std::endl;
+
+	std::vector<uint32_t> visible(count);
+	size_t flatCount = 0, treeCount = 0;
+	double flatMs = measure(iterations, [&] { flatCount = cullBoxes(frustum, boxes, 0, count, visible.data()); });
+	double treeMs = measure(iterations, [&] { treeCount = bvh.queryFrustum(frustum, visible.data()); });
+	std::cout << "  frustum: flat simd " << flatMs << " ms (" << flatCount << " visible), bvh " << treeMs << " ms (" << treeCount << " visible)" << std::endl;
+	if (flatCount != treeCount)
+		std::cout << "  MISMATCH: frustum counts differ" << std::endl;
+
+	//rays from the camera through random points of the view, like clicking around the window
+	const int rayCount = 1000;
+	std::uniform_real_distribution<float> screen(-0.4f, 0.4f);
+	std::vector<glm::vec3> directions(rayCount);
+	for (glm::vec3& direction : directions)
+		direction = glm::normalize(glm::vec3(screen(rng), screen(rng), -1.0f));
+	int bruteRays = count > 100000 ? rayCount / 10 : rayCount;
+
+	std::vector<uint32_t> bruteHits(bruteRays, UINT32_MAX);
+	double bruteMs = measure(1, [&] {
+		for (int r = 0; r < bruteRays; r++)
+			raycastBruteForce(boxes, eye, directions[r], 100.0f, bruteHits[r]);
+	});
+	std::vector<uint32_t> treeHits(rayCount, UINT32_MAX);
+	double rayMs = measure(iterations, [&] {
+		float distance;
+		for (int r = 0; r < rayCount; r++)
+			bvh.raycast(eye, directions[r], 100.0f, treeHits[r], distance);
+	});
+	int mismatches = 0;
+	for (int r = 0; r < bruteRays; r++)
+		mismatches += bruteHits[r] != treeHits[r];
+	std::cout << "  rays: brute force " << bruteRays / bruteMs / 1000.0 << " M rays/s, bvh " << rayCount / rayMs / 1000.0 << " M rays/s";
+	if (mismatches)
+		std::cout << ", " << mismatches << " MISMATCHES";
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = argc > 1 ? atoi(argv[1]) : 10;
+	for (size_t count : { 10000, 100000, 1000000 })
+		run(count, iterations);
+	return 0;
+}
@@ -0,0 +1,61 @@
+//frustum culling throughput, scalar vs simd vs thread pool, no gl context needed
+//  ./bin/cullbench [objects] [iterations] [threads]
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <culling.h>
+#include <threadpool.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+template <typename Fn>
+static size_t measure(const char* label, size_t objects, int iterations, Fn fn)
+{
+	size_t visible = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		visible = fn();
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+	std::cout << label << ": " << ms << " ms, " << objects / ms / 1000.0 << " M objects/s, " << visible << " visible" << std::endl;
+	return visible;
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	int iterations = argc > 2 ? atoi(argv[2]) : 20;
+	unsigned int threads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+
+	//objects scattered around a camera at the origin looking down -z, like the cube scene
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+	SphereSet spheres;
+	BoxSet boxes;
+	for (size_t i = 0; i < count; i++) {
+		glm::vec3 center(coordinate(rng), coordinate(rng), coordinate(rng));
+		spheres.add(center, 0.8660254f);
+		boxes.add(center, glm::vec3(0.5f));
+	}
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+	Frustum frustum = Frustum::fromMatrix(projection * view);
+
+	std::vector<uint32_t> visible(count);
+	ThreadPool pool(threads);
+	std::cout << count << " objects, " << pool.threadCount() + 1 << " threads" << std::endl;
+
+	size_t reference = measure("spheres scalar", count, iterations, [&] { return cullSpheresScalar(frustum, spheres, 0, count, visible.data()); });
+	measure("spheres simd", count, iterations, [&] { return cullSpheres(frustum, spheres, 0, count, visible.data()); });
+	size_t pooled = measure("spheres simd, thread pool", count, iterations, [&] { return cullSpheres(frustum, spheres, visible.data(), &pool); });
+	measure("boxes scalar", count, iterations, [&] { return cullBoxesScalar(frustum, boxes, 0, count, visible.data()); });
+	measure("boxes simd", count, iterations, [&] { return cullBoxes(frustum, boxes, 0, count, visible.data()); });
+	measure("boxes simd, thread pool", count, iterations, [&] { return cullBoxes(frustum, boxes, visible.data(), &pool); });
+
+	if (pooled != reference)
+		std::cout << "MISMATCH: simd kept " << pooled << ", scalar kept " << reference << std::endl;
+	std::cout << "draw count: " << count << " -> " << reference << " (" << 100.0 * reference / count << "% drawn)" << std::endl;
+	return 0;
+}
@@ -0,0 +1,102 @@
+//vertex welding & cache optimization results (acmr & bytes) for the cube and bigger generated meshes
+//  ./bin/meshbench
+#include <mesh.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+//the scene's cube, 36 expanded position + uv vertices
+static const float cubeVertices[] = {
+	-0.5f, -0.5f, -0.5f,  0.0f, 0.0f,   0.5f, -0.5f, -0.5f,  1.0f, 0.0f,   0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+	 0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,  -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+	-0.5f, -0.5f,  0.5f,  0.0f, 0.0f,   0.5f, -0.5f,  0.5f,  1.0f, 0.0f,   0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,  -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,  -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+	-0.5f,  0.5f,  0.5f,  1.0f, 0.0f,  -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,  -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,   0.5f,  0.5f, -0.5f,  1.0f, 1.0f,   0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+	 0.5f, -0.5f, -0.5f,  0.0f, 1.0f,   0.5f, -0.5f,  0.5f,  0.0f, 0.0f,   0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f, 1.0f,   0.5f, -0.5f, -0.5f,  1.0f, 1.0f,   0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+	 0.5f, -0.5f,  0.5f,  1.0f, 0.0f,  -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+	-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,   0.5f,  0.5f, -0.5f,  1.0f, 1.0f,   0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,  -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,  -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+};
+
+//a position + uv vertex onto the end of a soup
+static void pushVertex(std::vector<float>& soup, float x, float y, float z, float u, float v)
+{
+	float vertex[] = { x, y, z, u, v };
+	soup.insert(soup.end(), std::begin(vertex), std::end(vertex));
+}
+
+//an n by n quad grid, two triangles per quad, written row by row like a naive exporter would
+static std::vector<float> gridSoup(int n)
+{
+	std::vector<float> soup;
+	for (int y = 0; y < n; y++) {
+		for (int x = 0; x < n; x++) {
+			float u0 = (float)x / n, u1 = (float)(x + 1) / n, v0 = (float)y / n, v1 = (float)(y + 1) / n;
+			pushVertex(soup, u0, v0, 0.0f, u0, v0); pushVertex(soup, u1, v0, 0.0f, u1, v0); pushVertex(soup, u1, v1, 0.0f, u1, v1);
+			pushVertex(soup, u1, v1, 0.0f, u1, v1); pushVertex(soup, u0, v1, 0.0f, u0, v1); pushVertex(soup, u0, v0, 0.0f, u0, v0);
+		}
+	}
+	return soup;
+}
+
+//a uv sphere, the seam & poles repeat positions with different uvs so they don't weld
+static std::vector<float> sphereSoup(int rings, int segments)
+{
+	const float pi = 3.14159265f;
+	auto corner = [&](std::vector<float>& soup, int ring, int segment) {
+		float theta = pi * ring / rings, phi = 2.0f * pi * segment / segments;
+		pushVertex(soup, std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi),
+			(float)segment / segments, (float)ring / rings);
+	};
+	std::vector<float> soup;
+	for (int r = 0; r < rings; r++) {
+		for (int s = 0; s < segments; s++) {
+			corner(soup, r, s); corner(soup, r + 1, s); corner(soup, r + 1, s + 1);
+			corner(soup, r + 1, s + 1); corner(soup, r, s + 1); corner(soup, r, s);
+		}
+	}
+	return soup;
+}
+
+static void report(const char* name, const float* soup, size_t soupVertices)
+{
+	const unsigned int stride = 5;
+	auto start = std::chrono::steady_clock::now();
+	IndexedMesh welded = weldVertices(soup, soupVertices, stride);
+	double weldMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	IndexedMesh optimized = welded;
+	start = std::chrono::steady_clock::now();
+	optimizeVertexCache(optimized.indices, optimized.vertexCount());
+	optimizeVertexFetch(optimized);
+	double optimizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	size_t soupBytes = soupVertices * stride * sizeof(float);
+	size_t indexedBytes = optimized.vertexBytes() + optimized.indexBytes();
+	printf("%s: %zu triangles, %zu -> %zu vertices (weld %.2f ms, optimize %.2f ms)\n", name, soupVertices / 3,
+		soupVertices, optimized.vertexCount(), weldMs, optimizeMs);
+	//the soup has no reuse so it always misses 3 times per triangle
+	printf("  acmr (fifo 16/32): soup 3.000, welded %.3f/%.3f, optimized %.3f/%.3f\n",
+		averageCacheMissRatio(welded.indices, welded.vertexCount(), 16), averageCacheMissRatio(welded.indices, welded.vertexCount(), 32),
+		averageCacheMissRatio(optimized.indices, optimized.vertexCount(), 16), averageCacheMissRatio(optimized.indices, optimized.vertexCount(), 32));
+	printf("  buffers: soup %zu bytes, indexed %zu bytes (%zu vertex + %zu index, %s), %.1f%% saved\n", soupBytes, indexedBytes,
+		optimized.vertexBytes(), optimized.indexBytes(), optimized.shortIndices() ? "16 bit" : "32 bit",
+		100.0 * (1.0 - (double)indexedBytes / soupBytes));
+}
+
+int main()
+{
+	report("cube", cubeVertices, std::size(cubeVertices) / 5);
+	std::vector<float> grid = gridSoup(256);
+	report("grid 256x256", grid.data(), grid.size() / 5);
+	std::vector<float> sphere = sphereSoup(128, 256);
+	report("sphere 128x256", sphere.data(), sphere.size() / 5);
+	std::vector<float> bigGrid = gridSoup(1024);
+	report("grid 1024x1024", bigGrid.data(), bigGrid.size() / 5);
+	return 0;
+}
@@ -0,0 +1,82 @@
+//builds the mip chain of an image with the scalar filters, the simd ones & the simd ones spread over the
+//thread pool (box & kaiser), against glGenerateMipmap on a headless context, & checks the simd levels
+//match the scalar ones, run from the repo root:  ./bin/mipbench [image] [runs] [threads]
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <glad/glad.h>
+#include <glext.h>
+#include <headless.h>
+#include <mipgen.h>
+#include <threadpool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+//the biggest difference in any channel of any level
+static int maxDifference(const std::vector<MipLevel>& a, const std::vector<MipLevel>& b)
+{
+	int difference = 0;
+	for (size_t level = 0; level < a.size() && level < b.size(); level++)
+		for (size_t i = 0; i < a[level].pixels.size(); i++)
+			difference = std::max(difference, std::abs((int)a[level].pixels[i] - (int)b[level].pixels[i]));
+	return difference;
+}
+
+int main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : "assets/milly.png";
+	int runs = argc > 2 ? atoi(argv[2]) : 10;
+	unsigned int threads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+
+	int width, height, channels;
+	unsigned char* rgba = stbi_load(path, &width, &height, &channels, 4);
+	if (!rgba) {
+		std::cout << "Failed to load texture " << path << std::endl;
+		return -1;
+	}
+	ThreadPool pool(threads);
+	std::cout << path << ": " << width << "x" << height << ", " << runs << " runs, " << pool.threadCount() + 1 << " threads" << std::endl;
+
+	for (int f = 0; f < MIP_FILTER_COUNT; f++) {
+		MipOptions options;
+		options.filter = (MipFilter)f;
+		std::vector<MipLevel> scalar, simd;
+		auto time = [&](bool useSimd, ThreadPool* with, std::vector<MipLevel>& levels) {
+			options.simd = useSimd;
+			auto start = std::chrono::steady_clock::now();
+			for (int run = 0; run < runs; run++)
+				generateMips(rgba, width, height, options, levels, with);
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+		};
+		double scalarMs = time(false, nullptr, scalar);
+		double simdMs = time(true, nullptr, simd);
+		std::vector<MipLevel> pooled;
+		double pooledMs = time(true, &pool, pooled);
+		std::cout << mipFilterName(options.filter) << ": scalar " << scalarMs << " ms, simd " << simdMs << " ms ("
+			<< scalarMs / simdMs << "x), simd + pool " << pooledMs << " ms (" << scalarMs / pooledMs << "x), "
+			<< scalar.size() << " levels, max difference " << std::max(maxDifference(scalar, simd), maxDifference(simd, pooled)) << std::endl;
+	}
+
+	//the driver's own, which runs on the gl thread (on llvmpipe that's the cpu too)
+	if (createHeadlessContext()) {
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glFinish();
+		auto start = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; run++)
+			glGenerateMipmap(GL_TEXTURE_2D);
+		glFinish();
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+		std::cout << "glGenerateMipmap: " << ms << " ms on " << glGetString(GL_RENDERER) << std::endl;
+		glDeleteTextures(1, &texture);
+		destroyHeadlessContext();
+	}
+	stbi_image_free(rgba);
+	return 0;
+}
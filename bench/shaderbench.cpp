@@ -0,0 +1,61 @@
+//many programs built one at a time (the old blocking constructor) vs all submitted up front
+//& finished afterwards, run from the repo root:  ./bin/shaderbench [programs]
+#include <glad/glad.h>
+#include <shader.h>
+#include <glext.h>
+#include <headless.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+//a define after the #version line makes every program unique so the driver can't reuse one
+static ShaderSource variant(const ShaderSource& source, int index, int run)
+{
+	return source.withPrelude("#define VARIANT " + std::to_string(run * 100000 + index) + "\n");
+}
+
+int main(int argc, char** argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 100;
+
+	if (!createHeadlessContext())
+		return -1;
+
+	ShaderSource vertexCode, fragmentCode;
+	shaderSources.load("shaders/shader.vs", vertexCode);
+	shaderSources.load("shaders/shader.fs", fragmentCode);
+
+	//compile, check, compile, check... like Shader(vs, fs) used to
+	auto start = std::chrono::steady_clock::now();
+	std::vector<Shader> blocking(count);
+	for (int i = 0; i < count; i++) {
+		blocking[i].submitSource(variant(vertexCode, i, 0), variant(fragmentCode, i, 0));
+		blocking[i].finish();
+	}
+	double blockingMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	//everything submitted, then polled like the render loop would before finishing the stragglers
+	start = std::chrono::steady_clock::now();
+	std::vector<Shader> deferred(count);
+	for (int i = 0; i < count; i++)
+		deferred[i].submitSource(variant(vertexCode, i, 1), variant(fragmentCode, i, 1));
+	double submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	int readyAtSubmit = 0;
+	for (Shader& shader : deferred)
+		readyAtSubmit += glext.parallelShaderCompile && shader.ready();
+	for (Shader& shader : deferred)
+		shader.finish();
+	double deferredMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << count << " programs: blocking " << blockingMs << " ms, deferred " << deferredMs << " ms (submit "
+		<< submitMs << " ms, " << readyAtSubmit << " ready right after submitting)" << std::endl;
+
+	for (Shader& shader : blocking)
+		glDeleteProgram(shader.ID);
+	for (Shader& shader : deferred)
+		glDeleteProgram(shader.ID);
+	destroyHeadlessContext();
+	return 0;
+}
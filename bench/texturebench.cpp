@@ -0,0 +1,101 @@
+//decodes N copies of the assets serially & on the thread pool, then loads them all (& as many tiny baked
+//textures) through a TextureLoader on a headless context, more than its queue holds, & checks every one uploaded
+//run from the repo root:  ./bin/texturebench [copies] [threads]
+#include <textureloader.h>
+#include <threadpool.h>
+#include <headless.h>
+#include <stb_image.h>
+
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+	int copies = argc > 1 ? atoi(argv[1]) : 32;
+	unsigned int threads = argc > 2 ? (unsigned int)atoi(argv[2]) : 0;
+
+	std::vector<std::string> paths;
+	for (int i = 0; i < copies; i++)
+		for (const char* asset : { "assets/milly.png", "assets/boba.png", "assets/icon.png" })
+			paths.push_back(asset);
+	std::vector<DecodedImage> images(paths.size());
+
+	ThreadPool pool(threads);
+	std::cout << paths.size() << " images, " << pool.threadCount() + 1 << " threads" << std::endl;
+
+	auto decode = [&](size_t i) {
+		if (!TextureLoader::decodeFile(paths[i], true, images[i]))
+			std::cout << "Failed to load texture " << paths[i] << std::endl;
+	};
+	auto freeAll = [&] {
+		for (DecodedImage& image : images) {
+			stbi_image_free(image.pixels);
+			image.pixels = nullptr;
+		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < paths.size(); i++)
+		decode(i);
+	double serial = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	freeAll();
+
+	start = std::chrono::steady_clock::now();
+	pool.parallelFor(paths.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			decode(i);
+	});
+	double parallel = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	freeAll();
+
+	std::cout << "serial: " << serial << " ms (" << paths.size() * 1000.0 / serial << " images/s)" << std::endl;
+	std::cout << "parallel: " << parallel << " ms (" << paths.size() * 1000.0 / parallel << " images/s)" << std::endl;
+	std::cout << "speedup: " << serial / parallel << "x" << std::endl;
+
+	if (!createHeadlessContext())
+		return -1;
+	int failed = 0;
+	{
+		//a 4x4 bc1 file, mapped rather than decoded so those jobs are done (& pushing) almost at once,
+		//queued first they overflow the queue on their own
+		std::vector<std::string> loads;
+		std::string baked = (std::filesystem::temp_directory_path() / "texturebench.btex").string();
+		const unsigned char block[8] = {};
+		BakedLevel level;
+		level.width = 4;
+		level.height = 4;
+		level.data = block;
+		level.size = sizeof(block);
+		if (TextureLoader::bakedFormatSupported(BLOCK_BC1) && writeBakedTexture(baked, BLOCK_BC1, 0, { level }))
+			loads.insert(loads.end(), paths.size(), baked);
+		loads.insert(loads.end(), paths.begin(), paths.end());
+
+		TextureLoader loader(pool);
+		std::set<unsigned int> textures;
+		start = std::chrono::steady_clock::now();
+		for (const std::string& path : loads)
+			textures.insert(loader.load(path));
+		//nothing is uploaded for as long as the serial decode took, so the workers fill the
+		//queue & sit retrying their pushes before it starts draining
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(serial));
+		loader.finish();
+		double loaded = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::vector<UploadedTexture> uploads = loader.uploads();
+		for (const UploadedTexture& upload : uploads)
+			if (upload.bytes == 0 || textures.erase(upload.texture) == 0)
+				failed++;
+		failed += (int)textures.size();
+		std::cout << "loader: " << uploads.size() << " of " << loads.size() << " uploaded, " << failed << " failed, " << loaded << " ms" << std::endl;
+		loader.release();
+		std::filesystem::remove(baked);
+	}
+	destroyHeadlessContext();
+	return failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,75 @@
+//benchmark for the transform system, needs no gl context
+//  ./bin/transformbench [objects] [frames] [threads]
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <transforms.h>
+#include <threadpool.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+//runs fn for `frames` frames and prints the average milliseconds per frame
+template <typename Fn>
+static double measure(const char* label, int frames, Fn fn)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+		fn(frame * (1.0f / 60.0f));
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+	std::cout << label << ": " << ms << " ms/frame" << std::endl;
+	return ms;
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	int frames = argc > 2 ? atoi(argv[2]) : 50;
+	unsigned int threads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+
+	//the same animation the cube scene uses
+	TransformSystem transforms;
+	std::vector<glm::vec3> positions(count);
+	transforms.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		positions[i] = glm::vec3((float)(i % 100), (float)(i / 100 % 100), -(float)(i / 10000));
+		transforms.add(positions[i], glm::vec3(1.0f, 0.3f, 0.5f), glm::radians(-10.0f * (i % 36)), glm::vec3(0.5f, 1.0f, 0.0f), glm::radians(10.0f + (i % 36) * 100));
+	}
+	std::vector<glm::mat4> out(count);
+	float* outPtr = &out[0][0][0];
+
+	ThreadPool pool(threads);
+	std::cout << count << " transforms, simd width " << TransformSystem::simdWidth() << ", " << pool.threadCount() + 1 << " threads" << std::endl;
+
+	measure("glm translate/rotate/rotate", frames / 5 + 1, [&](float time) {
+		for (size_t i = 0; i < count; i++) {
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), positions[i]);
+			model = glm::rotate(model, glm::radians(-10.0f * (i % 36)), glm::vec3(1.0f, 0.3f, 0.5f));
+			out[i] = glm::rotate(model, time * glm::radians(10.0f + (i % 36) * 100), glm::vec3(0.5f, 1.0f, 0.0f));
+		}
+	});
+	measure("soa scalar", frames / 5 + 1, [&](float time) {
+		transforms.computeRangeScalar(time, 0, count, outPtr);
+	});
+	measure("soa simd, 1 thread", frames, [&](float time) {
+		transforms.computeModels(time, outPtr);
+	});
+	double pooled = measure("soa simd, thread pool", frames, [&](float time) {
+		transforms.computeModels(time, outPtr, &pool);
+	});
+	std::cout << (pooled * count / 1000000 <= 4.0 ? "under" : "over") << " the 4 ms per 1M target" << std::endl;
+
+	//checks the kernel against the scalar reference
+	std::vector<glm::mat4> reference(count);
+	transforms.computeRangeScalar(1.5f, 0, count, &reference[0][0][0]);
+	transforms.computeModels(1.5f, outPtr, &pool);
+	float maxError = 0.0f;
+	for (size_t i = 0; i < count; i++)
+		for (int c = 0; c < 4; c++)
+			for (int r = 0; r < 4; r++)
+				maxError = std::fmax(maxError, std::fabs(out[i][c][r] - reference[i][c][r]));
+	std::cout << "max error vs scalar: " << maxError << std::endl;
+	return 0;
+}
@@ -0,0 +1,73 @@
+//micro benchmark for the uniform setters & getters, run from the repo root so the
+//shaders/ folder is found:  ./bin/uniformbench [calls]
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shader.h>
+#include <headless.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+//runs fn `calls` times and prints how many calls per second that was
+template <typename Fn>
+static void measure(const char* label, long calls, Fn fn, const char* unit = "set calls/s")
+{
+	glFinish();
+	auto start = std::chrono::steady_clock::now();
+	for (long i = 0; i < calls; i++)
+		fn(i);
+	glFinish();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << label << ": " << (long)(calls / seconds) << " " << unit << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	long calls = argc > 1 ? atol(argv[1]) : 2000000;
+
+	if (!createHeadlessContext())
+		return -1;
+
+	Shader shader("shaders/shader.vs", "shaders/shader.fs");
+	shader.use();
+	glm::mat4 model(1.0f);
+
+	//what every setter used to do: a string keyed driver lookup per call
+	measure("glGetUniformLocation per set", calls, [&](long i) {
+		model[3][0] = (float)i;
+		glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, &model[0][0]);
+	});
+	//string setters now hash into the reflected table
+	measure("setMat4(name)", calls, [&](long i) {
+		model[3][0] = (float)i;
+		shader.setMat4("model", model);
+	});
+	//handle resolved once, the per draw path
+	UniformHandle modelLoc = shader.uniform("model");
+	measure("setMat4(handle)", calls, [&](long i) {
+		model[3][0] = (float)i;
+		shader.setMat4(modelLoc, model);
+	});
+	//the same value again, the shadow copy catches it & nothing is uploaded
+	measure("setMat4(handle), unchanged", calls, [&](long) {
+		shader.setMat4(modelLoc, model);
+	});
+
+	//reading back, what the getters used to do vs the shadow copy
+	float sum = 0.0f;
+	measure("glGetUniformfv per get", calls, [&](long) {
+		glm::mat4 value;
+		glGetUniformfv(shader.ID, modelLoc.location, &value[0][0]);
+		sum += value[3][0];
+	}, "get calls/s");
+	measure("getMat4(name)", calls, [&](long) {
+		sum += shader.getMat4("model")[3][0];
+	}, "get calls/s");
+	//keeps the reads from being optimized out
+	if (sum == 0.0f)
+		std::cout << "(model never changed)" << std::endl;
+
+	destroyHeadlessContext();
+	return 0;
+}
@@ -0,0 +1,289 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+const int binCount = 12;
+//traversal stacks this deep live on the stack, a deeper tree (lopsided sah splits on clustered
+//boxes) gets one on the heap, a level pops one entry & pushes two so depth + 1 is always enough
+const int localStackSize = 64;
+
+struct Bounds
+{
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	void grow(const glm::vec3& point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+	void grow(const Bounds& other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+	float area() const
+	{
+		glm::vec3 size = max - min;
+		if (size.x < 0.0f)
+			return 0.0f;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+};
+
+//where a box sits against a frustum plane set
+enum Classification { Outside, Intersecting, Inside };
+
+//tests a box against the planes still flagged in mask, clearing the planes it's fully inside of
+inline Classification classify(const Frustum& frustum, const float* min, const float* max, unsigned int& mask)
+{
+	glm::vec3 center((min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f);
+	glm::vec3 extent((max[0] - min[0]) * 0.5f, (max[1] - min[1]) * 0.5f, (max[2] - min[2]) * 0.5f);
+	for (int p = 0; p < 6; p++) {
+		if (!(mask & (1u << p)))
+			continue;
+		const glm::vec4& plane = frustum.planes[p];
+		float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		float reach = std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+		if (distance + reach < 0.0f)
+			return Outside;
+		//children of a box inside this plane are too, so they skip it
+		if (distance - reach >= 0.0f)
+			mask &= ~(1u << p);
+	}
+	return mask == 0 ? Inside : Intersecting;
+}
+
+//slab test, the entry distance or FLT_MAX for a miss
+inline float rayBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const float* min, const float* max, float maxDistance)
+{
+	float tmin = 0.0f;
+	float tmax = maxDistance;
+	for (int axis = 0; axis < 3; axis++) {
+		float t1 = (min[axis] - origin[axis]) * inverseDirection[axis];
+		float t2 = (max[axis] - origin[axis]) * inverseDirection[axis];
+		tmin = std::max(tmin, std::min(t1, t2));
+		tmax = std::min(tmax, std::max(t1, t2));
+	}
+	return tmin <= tmax ? tmin : FLT_MAX;
+}
+
+}
+
+void Bvh::build(const BoxSet& boxes)
+{
+	size_t count = boxes.size();
+	nodes.clear();
+	subtreeFirst.clear();
+	subtreeCount.clear();
+	maxDepth = 0;
+	objects.resize(count);
+	boxMin.resize(count);
+	boxMax.resize(count);
+	std::vector<glm::vec3> centroids(count);
+	for (size_t i = 0; i < count; i++) {
+		objects[i] = (uint32_t)i;
+		centroids[i] = glm::vec3(boxes.x[i], boxes.y[i], boxes.z[i]);
+		glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+		boxMin[i] = centroids[i] - extent;
+		boxMax[i] = centroids[i] + extent;
+	}
+	if (count == 0)
+		return;
+	//a binary tree with leaves of at least one object has under 2n nodes
+	nodes.reserve(2 * count);
+	subtreeFirst.reserve(2 * count);
+	subtreeCount.reserve(2 * count);
+	buildNode(centroids, 0, (uint32_t)count, 1);
+}
+
+uint32_t Bvh::buildNode(std::vector<glm::vec3>& centroids, uint32_t first, uint32_t count, int depth)
+{
+	maxDepth = std::max(maxDepth, depth);
+	Bounds bounds, centroidBounds;
+	for (uint32_t i = first; i < first + count; i++) {
+		uint32_t object = objects[i];
+		bounds.min = glm::min(bounds.min, boxMin[object]);
+		bounds.max = glm::max(bounds.max, boxMax[object]);
+		centroidBounds.grow(centroids[object]);
+	}
+
+	uint32_t index = (uint32_t)nodes.size();
+	Node node;
+	for (int axis = 0; axis < 3; axis++) {
+		node.min[axis] = bounds.min[axis];
+		node.max[axis] = bounds.max[axis];
+	}
+	node.rightOrFirst = first;
+	node.count = count;
+	nodes.push_back(node);
+	subtreeFirst.push_back(first);
+	subtreeCount.push_back(count);
+	if (count <= leafSize)
+		return index;
+
+	//binned sah: drop the centroids into bins along each axis & sweep for the cheapest split
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = FLT_MAX;
+	for (int axis = 0; axis < 3; axis++) {
+		float lo = centroidBounds.min[axis];
+		float extent = centroidBounds.max[axis] - lo;
+		if (extent <= 0.0f)
+			continue;
+		float scale = binCount / extent;
+
+		Bounds binBounds[binCount];
+		uint32_t binCounts[binCount] = {};
+		for (uint32_t i = first; i < first + count; i++) {
+			uint32_t object = objects[i];
+			int bin = std::min(binCount - 1, (int)((centroids[object][axis] - lo) * scale));
+			binCounts[bin]++;
+			binBounds[bin].min = glm::min(binBounds[bin].min, boxMin[object]);
+			binBounds[bin].max = glm::max(binBounds[bin].max, boxMax[object]);
+		}
+
+		//area * count for everything left of each split, then right of it
+		float leftCost[binCount - 1];
+		Bounds left;
+		uint32_t leftCount = 0;
+		for (int split = 0; split < binCount - 1; split++) {
+			left.grow(binBounds[split]);
+			leftCount += binCounts[split];
+			leftCost[split] = left.area() * leftCount;
+		}
+		Bounds right;
+		uint32_t rightCount = 0;
+		for (int split = binCount - 2; split >= 0; split--) {
+			right.grow(binBounds[split + 1]);
+			rightCount += binCounts[split + 1];
+			float cost = leftCost[split] + right.area() * rightCount;
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	uint32_t leftCount = 0;
+	if (bestAxis >= 0) {
+		float lo = centroidBounds.min[bestAxis];
+		float scale = binCount / (centroidBounds.max[bestAxis] - lo);
+		uint32_t* middle = std::partition(objects.data() + first, objects.data() + first + count, [&](uint32_t object) {
+			return std::min(binCount - 1, (int)((centroids[object][bestAxis] - lo) * scale)) <= bestSplit;
+		});
+		leftCount = (uint32_t)(middle - (objects.data() + first));
+	}
+	//every centroid in one spot (or one side), just halve the list
+	if (leftCount == 0 || leftCount == count)
+		leftCount = count / 2;
+
+	buildNode(centroids, first, leftCount, depth + 1);
+	uint32_t right = buildNode(centroids, first + leftCount, count - leftCount, depth + 1);
+	nodes[index].rightOrFirst = right;
+	nodes[index].count = 0;
+	return index;
+}
+
+size_t Bvh::queryFrustum(const Frustum& frustum, uint32_t* visible) const
+{
+	if (nodes.empty())
+		return 0;
+
+	struct Entry
+	{
+		uint32_t node;
+		unsigned int mask;
+	};
+	Entry local[localStackSize];
+	std::vector<Entry> deep;
+	Entry* stack = local;
+	if (maxDepth + 1 > localStackSize) {
+		deep.resize(maxDepth + 1);
+		stack = deep.data();
+	}
+	int top = 0;
+	stack[top++] = { 0, 0x3f };
+	size_t found = 0;
+	while (top > 0) {
+		Entry entry = stack[--top];
+		const Node& node = nodes[entry.node];
+		unsigned int mask = entry.mask;
+		Classification where = classify(frustum, node.min, node.max, mask);
+		if (where == Outside)
+			continue;
+		if (where == Inside) {
+			//the whole subtree is visible, its objects are one contiguous run
+			const uint32_t* run = objects.data() + subtreeFirst[entry.node];
+			std::copy(run, run + subtreeCount[entry.node], visible + found);
+			found += subtreeCount[entry.node];
+			continue;
+		}
+		if (node.count > 0) {
+			for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++) {
+				uint32_t object = objects[i];
+				unsigned int objectMask = mask;
+				if (classify(frustum, &boxMin[object][0], &boxMax[object][0], objectMask) != Outside)
+					visible[found++] = object;
+			}
+			continue;
+		}
+		stack[top++] = { node.rightOrFirst, mask };
+		stack[top++] = { entry.node + 1, mask };
+	}
+	return found;
+}
+
+bool Bvh::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t& hit, float& distance) const
+{
+	if (nodes.empty())
+		return false;
+	glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+	float best = maxDistance;
+	bool found = false;
+	uint32_t local[localStackSize];
+	std::vector<uint32_t> deep;
+	uint32_t* stack = local;
+	if (maxDepth + 1 > localStackSize) {
+		deep.resize(maxDepth + 1);
+		stack = deep.data();
+	}
+	int top = 0;
+	if (rayBox(origin, inverseDirection, nodes[0].min, nodes[0].max, best) == FLT_MAX)
+		return false;
+	stack[top++] = 0;
+	while (top > 0) {
+		const Node& node = nodes[stack[--top]];
+		if (node.count > 0) {
+			for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++) {
+				uint32_t object = objects[i];
+				float t = rayBox(origin, inverseDirection, &boxMin[object][0], &boxMax[object][0], best);
+				if (t < best) {
+					best = t;
+					hit = object;
+					found = true;
+				}
+			}
+			continue;
+		}
+		//nearer child goes on the stack last so it's visited first & shrinks best sooner
+		uint32_t children[2] = { (uint32_t)(&node - nodes.data()) + 1, node.rightOrFirst };
+		float t[2];
+		for (int c = 0; c < 2; c++)
+			t[c] = rayBox(origin, inverseDirection, nodes[children[c]].min, nodes[children[c]].max, best);
+		int nearer = t[0] <= t[1] ? 0 : 1;
+		if (t[1 - nearer] != FLT_MAX)
+			stack[top++] = children[1 - nearer];
+		if (t[nearer] != FLT_MAX)
+			stack[top++] = children[nearer];
+	}
+	if (found)
+		distance = best;
+	return found;
+}
@@ -0,0 +1,225 @@
+#include "culling.h"
+#include "threadpool.h"
+#include "simd.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+Frustum Frustum::fromMatrix(const glm::mat4& m)
+{
+	//glm is column major so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0]; // left
+	frustum.planes[1] = rows[3] - rows[0]; // right
+	frustum.planes[2] = rows[3] + rows[1]; // bottom
+	frustum.planes[3] = rows[3] - rows[1]; // top
+	frustum.planes[4] = rows[3] + rows[2]; // near
+	frustum.planes[5] = rows[3] - rows[2]; // far
+	for (glm::vec4& plane : frustum.planes) {
+		float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		plane = plane * (1.0f / length);
+	}
+	return frustum;
+}
+
+bool Frustum::containsSphere(const glm::vec3& center, float radius) const
+{
+	for (const glm::vec4& plane : planes)
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+			return false;
+	return true;
+}
+
+bool Frustum::containsBox(const glm::vec3& center, const glm::vec3& extent) const
+{
+	for (const glm::vec4& plane : planes) {
+		//how far the box reaches towards the plane
+		float reach = std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -reach)
+			return false;
+	}
+	return true;
+}
+
+void SphereSet::add(const glm::vec3& center, float r)
+{
+	x.push_back(center.x);
+	y.push_back(center.y);
+	z.push_back(center.z);
+	radius.push_back(r);
+}
+
+void SphereSet::clear()
+{
+	x.clear();
+	y.clear();
+	z.clear();
+	radius.clear();
+}
+
+void BoxSet::add(const glm::vec3& center, const glm::vec3& extent)
+{
+	x.push_back(center.x);
+	y.push_back(center.y);
+	z.push_back(center.z);
+	extentX.push_back(extent.x);
+	extentY.push_back(extent.y);
+	extentZ.push_back(extent.z);
+}
+
+void BoxSet::clear()
+{
+	x.clear();
+	y.clear();
+	z.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+}
+
+size_t cullSpheresScalar(const Frustum& frustum, const SphereSet& spheres, size_t begin, size_t end, uint32_t* visible)
+{
+	size_t count = 0;
+	for (size_t i = begin; i < end; i++)
+		if (frustum.containsSphere(glm::vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]))
+			visible[count++] = (uint32_t)i;
+	return count;
+}
+
+size_t cullBoxesScalar(const Frustum& frustum, const BoxSet& boxes, size_t begin, size_t end, uint32_t* visible)
+{
+	size_t count = 0;
+	for (size_t i = begin; i < end; i++)
+		if (frustum.containsBox(glm::vec3(boxes.x[i], boxes.y[i], boxes.z[i]), glm::vec3(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i])))
+			visible[count++] = (uint32_t)i;
+	return count;
+}
+
+#ifdef SIMD_AVAILABLE
+
+using namespace simd;
+
+//appends first + the index of every set bit to visible
+static inline size_t writeLanes(unsigned int bits, uint32_t first, uint32_t* visible)
+{
+	size_t count = 0;
+	while (bits) {
+#ifdef _MSC_VER
+		unsigned long lane;
+		_BitScanForward(&lane, bits);
+#else
+		unsigned int lane = __builtin_ctz(bits);
+#endif
+		visible[count++] = first + lane;
+		bits &= bits - 1;
+	}
+	return count;
+}
+
+size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, size_t begin, size_t end, uint32_t* visible)
+{
+	vfloat planes[6][4];
+	for (int p = 0; p < 6; p++)
+		for (int c = 0; c < 4; c++)
+			planes[p][c] = vset(frustum.planes[p][c]);
+
+	size_t count = 0;
+	size_t i = begin;
+	for (; i + width <= end; i += width) {
+		vfloat x = vload(&spheres.x[i]), y = vload(&spheres.y[i]), z = vload(&spheres.z[i]);
+		vfloat negRadius = vsub(vset(0.0f), vload(&spheres.radius[i]));
+		vfloat outside = vset(0.0f);
+		for (int p = 0; p < 6; p++) {
+			vfloat distance = vadd(vadd(vmul(planes[p][0], x), vmul(planes[p][1], y)), vadd(vmul(planes[p][2], z), planes[p][3]));
+			outside = vor(outside, vless(distance, negRadius));
+		}
+		unsigned int inside = ~vmovemask(outside) & ((1u << width) - 1);
+		count += writeLanes(inside, (uint32_t)i, visible + count);
+	}
+	return count + cullSpheresScalar(frustum, spheres, i, end, visible + count);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoxSet& boxes, size_t begin, size_t end, uint32_t* visible)
+{
+	vfloat planes[6][4];
+	vfloat absPlanes[6][3];
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++)
+			planes[p][c] = vset(frustum.planes[p][c]);
+		for (int c = 0; c < 3; c++)
+			absPlanes[p][c] = vset(std::fabs(frustum.planes[p][c]));
+	}
+
+	size_t count = 0;
+	size_t i = begin;
+	for (; i + width <= end; i += width) {
+		vfloat x = vload(&boxes.x[i]), y = vload(&boxes.y[i]), z = vload(&boxes.z[i]);
+		vfloat ex = vload(&boxes.extentX[i]), ey = vload(&boxes.extentY[i]), ez = vload(&boxes.extentZ[i]);
+		vfloat outside = vset(0.0f);
+		for (int p = 0; p < 6; p++) {
+			vfloat distance = vadd(vadd(vmul(planes[p][0], x), vmul(planes[p][1], y)), vadd(vmul(planes[p][2], z), planes[p][3]));
+			vfloat reach = vadd(vadd(vmul(absPlanes[p][0], ex), vmul(absPlanes[p][1], ey)), vmul(absPlanes[p][2], ez));
+			outside = vor(outside, vless(vadd(distance, reach), vset(0.0f)));
+		}
+		unsigned int inside = ~vmovemask(outside) & ((1u << width) - 1);
+		count += writeLanes(inside, (uint32_t)i, visible + count);
+	}
+	return count + cullBoxesScalar(frustum, boxes, i, end, visible + count);
+}
+
+#else
+
+size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, size_t begin, size_t end, uint32_t* visible)
+{
+	return cullSpheresScalar(frustum, spheres, begin, end, visible);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoxSet& boxes, size_t begin, size_t end, uint32_t* visible)
+{
+	return cullBoxesScalar(frustum, boxes, begin, end, visible);
+}
+
+#endif
+
+//runs cull over chunks on the pool, each chunk writes its survivors at its own start
+//in visible & the gaps are closed afterwards (survivors never move forwards so memmove is safe)
+template <typename Cull>
+static size_t cullParallel(size_t count, uint32_t* visible, ThreadPool* pool, Cull cull)
+{
+	const size_t grain = 65536;
+	if (pool == nullptr || count <= grain)
+		return cull(0, count, visible);
+
+	std::vector<size_t> chunkCounts((count + grain - 1) / grain);
+	pool->parallelFor(count, grain, [&](size_t begin, size_t end) {
+		chunkCounts[begin / grain] = cull(begin, end, visible + begin);
+	});
+	size_t total = chunkCounts[0];
+	for (size_t chunk = 1; chunk < chunkCounts.size(); chunk++) {
+		memmove(visible + total, visible + chunk * grain, chunkCounts[chunk] * sizeof(uint32_t));
+		total += chunkCounts[chunk];
+	}
+	return total;
+}
+
+size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, uint32_t* visible, ThreadPool* pool)
+{
+	return cullParallel(spheres.size(), visible, pool, [&](size_t begin, size_t end, uint32_t* out) {
+		return cullSpheres(frustum, spheres, begin, end, out);
+	});
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoxSet& boxes, uint32_t* visible, ThreadPool* pool)
+{
+	return cullParallel(boxes.size(), visible, pool, [&](size_t begin, size_t end, uint32_t* out) {
+		return cullBoxes(frustum, boxes, begin, end, out);
+	});
+}
@@ -0,0 +1,126 @@
+#include "filewatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+static std::string canonicalPath(const std::string& path)
+{
+	std::error_code error;
+	std::string result = std::filesystem::weakly_canonical(path, error).string();
+	return error ? path : result;
+}
+
+static int64_t writeStamp(const std::string& path)
+{
+	std::error_code error;
+	auto time = std::filesystem::last_write_time(path, error);
+	return error ? 0 : (int64_t)time.time_since_epoch().count();
+}
+
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+	inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	stopping = true;
+	thread.join();
+#ifdef __linux__
+	if (inotify >= 0)
+		close(inotify);
+#endif
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+	std::string canonical = canonicalPath(path);
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const Watched& file : files) {
+		if (file.canonical == canonical)
+			return;
+	}
+	files.push_back({ path, canonical, writeStamp(path) });
+#ifdef __linux__
+	if (inotify < 0)
+		return;
+	std::string directory = std::filesystem::path(canonical).parent_path().string();
+	for (const auto& watched : directories) {
+		if (watched.second == directory)
+			return;
+	}
+	//close_write for editors that write in place, moved_to for the ones that write a temp file & rename it over
+	//(not create, a new file is still empty then & its close_write follows anyway)
+	int descriptor = inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (descriptor >= 0)
+		directories.push_back({ descriptor, directory });
+#endif
+}
+
+std::vector<std::string> FileWatcher::changes()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<std::string> result;
+	result.swap(changed);
+	return result;
+}
+
+void FileWatcher::markChanged(const std::string& canonical)
+{
+	for (const Watched& file : files) {
+		if (file.canonical == canonical && std::find(changed.begin(), changed.end(), file.path) == changed.end())
+			changed.push_back(file.path);
+	}
+}
+
+void FileWatcher::run()
+{
+#ifdef __linux__
+	if (inotify >= 0) {
+		alignas(inotify_event) char buffer[4096];
+		while (!stopping) {
+			//wakes up now & then to notice stopping
+			pollfd descriptor = { inotify, POLLIN, 0 };
+			if (poll(&descriptor, 1, 100) <= 0)
+				continue;
+			ssize_t length;
+			while ((length = read(inotify, buffer, sizeof(buffer))) > 0) {
+				std::lock_guard<std::mutex> lock(mutex);
+				for (char* at = buffer; at < buffer + length; ) {
+					const inotify_event* event = (const inotify_event*)at;
+					at += sizeof(inotify_event) + event->len;
+					if (event->len == 0)
+						continue;
+					for (const auto& watched : directories) {
+						if (watched.first == event->wd)
+							markChanged((std::filesystem::path(watched.second) / event->name).string());
+					}
+				}
+			}
+		}
+		return;
+	}
+#endif
+	//no inotify, compares every file's last write time instead
+	while (!stopping) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+		std::lock_guard<std::mutex> lock(mutex);
+		for (Watched& file : files) {
+			int64_t stamp = writeStamp(file.path);
+			if (stamp != file.stamp) {
+				file.stamp = stamp;
+				markChanged(file.canonical);
+			}
+		}
+	}
+}
@@ -0,0 +1,170 @@
+#include "glext.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+GLExtensions glext;
+
+//the extension list read once by loadGLExtensions instead of walked for every lookup
+static std::unordered_set<std::string> extensions;
+
+static void readExtensions()
+{
+	extensions.clear();
+	int count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (int i = 0; i < count; i++) {
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension)
+			extensions.insert(extension);
+	}
+}
+
+bool hasGLExtension(const char* name)
+{
+	if (extensions.empty())
+		readExtensions();
+	return extensions.count(name) != 0;
+}
+
+//true when the context is at least major.minor
+static bool versionAtLeast(int major, int minor)
+{
+	return glext.majorVersion > major || (glext.majorVersion == major && glext.minorVersion >= minor);
+}
+
+//true when every pointer in the list loaded
+static bool allLoaded(std::initializer_list<const void*> procs)
+{
+	for (const void* proc : procs) {
+		if (!proc)
+			return false;
+	}
+	return true;
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+	glext = GLExtensions();
+	glGetIntegerv(GL_MAJOR_VERSION, &glext.majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &glext.minorVersion);
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+	const char* version = (const char*)glGetString(GL_VERSION);
+	glext.renderer = renderer ? renderer : "";
+	glext.version = version ? version : "";
+	readExtensions();
+
+	if (versionAtLeast(4, 1) || hasGLExtension("GL_ARB_get_program_binary")) {
+		glext.GetProgramBinary = (glextGetProgramBinaryProc)load("glGetProgramBinary");
+		glext.ProgramBinary = (glextProgramBinaryProc)load("glProgramBinary");
+		glext.ProgramParameteri = (glextProgramParameteriProc)load("glProgramParameteri");
+		//some drivers expose the extension but no formats to save in
+		int formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		glext.programBinary = glext.GetProgramBinary && glext.ProgramBinary && glext.ProgramParameteri && formats > 0;
+	}
+
+	if (hasGLExtension("GL_KHR_parallel_shader_compile")) {
+		glext.MaxShaderCompilerThreads = (glextMaxShaderCompilerThreadsProc)load("glMaxShaderCompilerThreadsKHR");
+		glext.parallelShaderCompile = true;
+	}
+	else if (hasGLExtension("GL_ARB_parallel_shader_compile")) {
+		glext.MaxShaderCompilerThreads = (glextMaxShaderCompilerThreadsProc)load("glMaxShaderCompilerThreadsARB");
+		glext.parallelShaderCompile = true;
+	}
+	//lets the driver use as many compiler threads as it likes
+	if (glext.MaxShaderCompilerThreads)
+		glext.MaxShaderCompilerThreads(0xFFFFFFFF);
+
+	if (versionAtLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage")) {
+		glext.BufferStorage = (glextBufferStorageProc)load("glBufferStorage");
+		glext.bufferStorage = glext.BufferStorage != nullptr;
+	}
+
+	if (versionAtLeast(4, 2) || hasGLExtension("GL_ARB_texture_storage")) {
+		glext.TexStorage3D = (glextTexStorage3DProc)load("glTexStorage3D");
+		glext.textureStorage = glext.TexStorage3D != nullptr;
+	}
+
+	glext.textureCompressionS3TC = hasGLExtension("GL_EXT_texture_compression_s3tc");
+	glext.textureCompressionBPTC = versionAtLeast(4, 2) || hasGLExtension("GL_ARB_texture_compression_bptc");
+
+	if (versionAtLeast(4, 2) || hasGLExtension("GL_ARB_base_instance")) {
+		glext.DrawElementsInstancedBaseInstance = (glextDrawElementsInstancedBaseInstanceProc)load("glDrawElementsInstancedBaseInstance");
+		glext.baseInstance = glext.DrawElementsInstancedBaseInstance != nullptr;
+	}
+
+	if (versionAtLeast(4, 5) || hasGLExtension("GL_ARB_direct_state_access")) {
+		glext.CreateBuffers = (glextCreateBuffersProc)load("glCreateBuffers");
+		glext.NamedBufferStorage = (glextNamedBufferStorageProc)load("glNamedBufferStorage");
+		glext.CreateVertexArrays = (glextCreateVertexArraysProc)load("glCreateVertexArrays");
+		glext.VertexArrayVertexBuffer = (glextVertexArrayVertexBufferProc)load("glVertexArrayVertexBuffer");
+		glext.VertexArrayElementBuffer = (glextVertexArrayElementBufferProc)load("glVertexArrayElementBuffer");
+		glext.VertexArrayAttribFormat = (glextVertexArrayAttribFormatProc)load("glVertexArrayAttribFormat");
+		glext.VertexArrayAttribIFormat = (glextVertexArrayAttribIFormatProc)load("glVertexArrayAttribIFormat");
+		glext.VertexArrayAttribBinding = (glextVertexArrayAttribBindingProc)load("glVertexArrayAttribBinding");
+		glext.VertexArrayBindingDivisor = (glextVertexArrayBindingDivisorProc)load("glVertexArrayBindingDivisor");
+		glext.EnableVertexArrayAttrib = (glextEnableVertexArrayAttribProc)load("glEnableVertexArrayAttrib");
+		glext.CreateTextures = (glextCreateTexturesProc)load("glCreateTextures");
+		glext.TextureStorage2D = (glextTextureStorage2DProc)load("glTextureStorage2D");
+		glext.TextureSubImage2D = (glextTextureSubImage2DProc)load("glTextureSubImage2D");
+		glext.TextureStorage3D = (glextTextureStorage3DProc)load("glTextureStorage3D");
+		glext.TextureSubImage3D = (glextTextureSubImage3DProc)load("glTextureSubImage3D");
+		glext.CompressedTextureSubImage2D = (glextCompressedTextureSubImage2DProc)load("glCompressedTextureSubImage2D");
+		glext.TextureParameteri = (glextTextureParameteriProc)load("glTextureParameteri");
+		glext.GenerateTextureMipmap = (glextGenerateTextureMipmapProc)load("glGenerateTextureMipmap");
+		//a half loaded set is worse than none, it's all or nothing
+		glext.directStateAccess = allLoaded({ (const void*)glext.CreateBuffers, (const void*)glext.NamedBufferStorage,
+			(const void*)glext.CreateVertexArrays, (const void*)glext.VertexArrayVertexBuffer, (const void*)glext.VertexArrayElementBuffer,
+			(const void*)glext.VertexArrayAttribFormat, (const void*)glext.VertexArrayAttribIFormat, (const void*)glext.VertexArrayAttribBinding,
+			(const void*)glext.VertexArrayBindingDivisor, (const void*)glext.EnableVertexArrayAttrib, (const void*)glext.CreateTextures,
+			(const void*)glext.TextureStorage2D, (const void*)glext.TextureSubImage2D, (const void*)glext.TextureStorage3D,
+			(const void*)glext.TextureSubImage3D, (const void*)glext.CompressedTextureSubImage2D, (const void*)glext.TextureParameteri,
+			(const void*)glext.GenerateTextureMipmap });
+	}
+
+	//GLEXP_GL33=1 keeps everything on the plain 3.3 calls, for comparing against the fast paths
+	const char* coreOnly = getenv("GLEXP_GL33");
+	if (coreOnly && strcmp(coreOnly, "0") != 0)
+		glext.disableFastPaths();
+}
+
+void GLExtensions::disableFastPaths()
+{
+	programBinary = false;
+	parallelShaderCompile = false;
+	bufferStorage = false;
+	textureStorage = false;
+	textureCompressionS3TC = false;
+	textureCompressionBPTC = false;
+	baseInstance = false;
+	directStateAccess = false;
+}
+
+static const char* yesNo(bool value)
+{
+	return value ? "yes" : "no";
+}
+
+std::string describeGLPaths()
+{
+	std::ostringstream out;
+	out << "GL " << glext.majorVersion << "." << glext.minorVersion << " (" << glext.version << ") on " << glext.renderer << "\n";
+	out << "  direct state access:     " << yesNo(glext.directStateAccess) << "\n";
+	out << "  buffer storage:          " << yesNo(glext.bufferStorage) << "\n";
+	out << "  texture storage:         " << yesNo(glext.textureStorage) << "\n";
+	out << "  s3tc / bptc:             " << yesNo(glext.textureCompressionS3TC) << " / " << yesNo(glext.textureCompressionBPTC) << "\n";
+	out << "  base instance:           " << yesNo(glext.baseInstance) << "\n";
+	out << "  parallel shader compile: " << yesNo(glext.parallelShaderCompile) << "\n";
+	out << "  program binaries:        " << yesNo(glext.programBinary) << "\n";
+	out << "paths:\n";
+	out << "  instance uploads: " << (glext.persistentStreaming() ? "persistent mapped ring + base instance" : "orphaned glMapBufferRange") << "\n";
+	out << "  resource setup:   " << (glext.directStateAccess ? "direct state access, immutable storage" : "bind to edit") << "\n";
+	out << "  baked textures:   " << (glext.textureCompressionS3TC || glext.textureCompressionBPTC ? "uploaded compressed straight from the mapping" : "unsupported, decoded from the source images") << "\n";
+	out << "  shader builds:    " << (glext.parallelShaderCompile ? "polled without blocking" : "blocking at first use") << "\n";
+	out << "  shader cache:     " << (glext.programBinary ? "program binaries" : "off, compiled every run") << "\n";
+	return out.str();
+}
@@ -0,0 +1,40 @@
+#include "glresources.h"
+#include "glext.h"
+#include "glstate.h"
+
+#include <glad/glad.h>
+
+unsigned int createVertexArray()
+{
+	unsigned int vertexArray = 0;
+	if (glext.directStateAccess)
+		glext.CreateVertexArrays(1, &vertexArray);
+	else
+		glGenVertexArrays(1, &vertexArray);
+	return vertexArray;
+}
+
+unsigned int createStaticBuffer(size_t bytes, const void* data)
+{
+	unsigned int buffer = 0;
+	if (glext.directStateAccess) {
+		glext.CreateBuffers(1, &buffer);
+		glext.NamedBufferStorage(buffer, bytes, data, 0);
+		return buffer;
+	}
+	glGenBuffers(1, &buffer);
+	//filled through GL_ARRAY_BUFFER whatever it's for, binding GL_ELEMENT_ARRAY_BUFFER would change the bound vao
+	glstate.bindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_STATIC_DRAW);
+	return buffer;
+}
+
+void setIndexBuffer(unsigned int vertexArray, unsigned int indexBuffer)
+{
+	if (glext.directStateAccess) {
+		glext.VertexArrayElementBuffer(vertexArray, indexBuffer);
+		return;
+	}
+	glstate.bindVertexArray(vertexArray);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+}
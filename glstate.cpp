@@ -0,0 +1,236 @@
+#include "glstate.h"
+
+#include <cstdio>
+
+GLState glstate;
+
+unsigned long long GLStateStats::totalIssued() const
+{
+	unsigned long long sum = 0;
+	for (unsigned long long count : issued)
+		sum += count;
+	return sum;
+}
+
+unsigned long long GLStateStats::totalElided() const
+{
+	unsigned long long sum = 0;
+	for (unsigned long long count : elided)
+		sum += count;
+	return sum;
+}
+
+bool GLState::change(GLStateKind kind, bool changed)
+{
+	if (changed) {
+		frame.issued[kind]++;
+		totals.issued[kind]++;
+	}
+	else {
+		frame.elided[kind]++;
+		totals.elided[kind]++;
+	}
+	return changed;
+}
+
+unsigned int* GLState::bufferSlot(unsigned int target)
+{
+	switch (target) {
+	case GL_ARRAY_BUFFER: return &arrayBuffer;
+	case GL_UNIFORM_BUFFER: return &uniformBuffer;
+	case GL_PIXEL_UNPACK_BUFFER: return &pixelUnpackBuffer;
+	default: return nullptr;
+	}
+}
+
+void GLState::useProgram(unsigned int id)
+{
+	if (change(GLSTATE_PROGRAM, program != id)) {
+		program = id;
+		glUseProgram(id);
+	}
+}
+
+void GLState::bindVertexArray(unsigned int id)
+{
+	if (change(GLSTATE_VERTEX_ARRAY, vertexArray != id)) {
+		vertexArray = id;
+		glBindVertexArray(id);
+	}
+}
+
+void GLState::bindBuffer(unsigned int target, unsigned int buffer)
+{
+	unsigned int* slot = bufferSlot(target);
+	if (change(GLSTATE_BUFFER, !slot || *slot != buffer)) {
+		if (slot)
+			*slot = buffer;
+		glBindBuffer(target, buffer);
+	}
+}
+
+void GLState::bindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+	bool cached = target == GL_UNIFORM_BUFFER && index < 16;
+	if (change(GLSTATE_BUFFER, !cached || uniformBufferBases[index] != buffer || uniformBuffer != buffer)) {
+		if (cached)
+			uniformBufferBases[index] = buffer;
+		if (target == GL_UNIFORM_BUFFER)
+			uniformBuffer = buffer;
+		glBindBufferBase(target, index, buffer);
+	}
+}
+
+void GLState::activeTexture(unsigned int unit)
+{
+	if (change(GLSTATE_TEXTURE, activeUnit != unit)) {
+		activeUnit = unit;
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+}
+
+void GLState::bindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+	//only 2d textures are tracked, other targets always rebind
+	bool cached = target == GL_TEXTURE_2D && unit < maxTextureUnits;
+	if (cached && textures2D[unit] == texture) {
+		change(GLSTATE_TEXTURE, false);
+		return;
+	}
+	activeTexture(unit);
+	change(GLSTATE_TEXTURE, true);
+	if (cached)
+		textures2D[unit] = texture;
+	glBindTexture(target, texture);
+}
+
+void GLState::bindTextureForEdit(unsigned int target, unsigned int texture)
+{
+	if (activeUnit == unknown)
+		activeTexture(0);
+	bindTexture(activeUnit, target, texture);
+}
+
+void GLState::polygonMode(unsigned int mode)
+{
+	if (change(GLSTATE_POLYGON_MODE, polygonFill != mode)) {
+		polygonFill = mode;
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+}
+
+void GLState::setDepthTest(bool enabled)
+{
+	if (change(GLSTATE_DEPTH, depthTest != (int)enabled)) {
+		depthTest = enabled;
+		if (enabled)
+			glEnable(GL_DEPTH_TEST);
+		else
+			glDisable(GL_DEPTH_TEST);
+	}
+}
+
+void GLState::depthFunc(unsigned int func)
+{
+	if (change(GLSTATE_DEPTH, depthFunction != func)) {
+		depthFunction = func;
+		glDepthFunc(func);
+	}
+}
+
+void GLState::depthMask(bool write)
+{
+	if (change(GLSTATE_DEPTH, depthWrite != (int)write)) {
+		depthWrite = write;
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GLState::setBlend(bool enabled)
+{
+	if (change(GLSTATE_BLEND, blend != (int)enabled)) {
+		blend = enabled;
+		if (enabled)
+			glEnable(GL_BLEND);
+		else
+			glDisable(GL_BLEND);
+	}
+}
+
+void GLState::blendFunc(unsigned int source, unsigned int destination)
+{
+	if (change(GLSTATE_BLEND, blendSource != source || blendDestination != destination)) {
+		blendSource = source;
+		blendDestination = destination;
+		glBlendFunc(source, destination);
+	}
+}
+
+void GLState::invalidate()
+{
+	program = vertexArray = unknown;
+	arrayBuffer = uniformBuffer = pixelUnpackBuffer = unknown;
+	for (unsigned int& buffer : uniformBufferBases)
+		buffer = unknown;
+	activeUnit = unknown;
+	for (unsigned int& texture : textures2D)
+		texture = unknown;
+	polygonFill = depthFunction = blendSource = blendDestination = unknown;
+	depthTest = depthWrite = blend = -1;
+}
+
+void GLState::forgetBuffer(unsigned int buffer)
+{
+	//gl unbinds a deleted buffer from everywhere it was bound
+	for (unsigned int* slot : { &arrayBuffer, &uniformBuffer, &pixelUnpackBuffer }) {
+		if (*slot == buffer)
+			*slot = 0;
+	}
+	for (unsigned int& base : uniformBufferBases) {
+		if (base == buffer)
+			base = 0;
+	}
+}
+
+void GLState::forgetTexture(unsigned int texture)
+{
+	for (unsigned int& bound : textures2D) {
+		if (bound == texture)
+			bound = 0;
+	}
+}
+
+void GLState::forgetProgram(unsigned int id)
+{
+	//a bound program lives on until it's unbound, so the binding is unknown rather than 0
+	if (program == id)
+		program = unknown;
+}
+
+void GLState::forgetVertexArray(unsigned int id)
+{
+	if (vertexArray == id)
+		vertexArray = 0;
+}
+
+void GLState::beginFrame()
+{
+	previousFrame = frame;
+	frame = GLStateStats();
+}
+
+std::string GLState::summary() const
+{
+	static const char* names[GLSTATE_KIND_COUNT] = { "program", "vertex array", "buffer", "texture", "polygon mode", "depth", "blend" };
+	std::string text;
+	char line[128];
+	for (int kind = 0; kind < GLSTATE_KIND_COUNT; kind++) {
+		if (totals.issued[kind] + totals.elided[kind] == 0)
+			continue;
+		snprintf(line, sizeof(line), "gl %-14s issued %10llu  elided %10llu\n", names[kind], totals.issued[kind], totals.elided[kind]);
+		text += line;
+	}
+	snprintf(line, sizeof(line), "gl state calls elided: %llu of %llu\n", totals.totalElided(), totals.totalIssued() + totals.totalElided());
+	text += line;
+	return text;
+}
@@ -0,0 +1,162 @@
+#include "lzblock.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//a match is at least this long, & lz4 keeps the last bytes of a block literal so a decoder can copy
+//in wide chunks without checking every byte (kept for compatibility, ours checks anyway)
+static const size_t minMatch = 4;
+static const size_t lastLiterals = 5;
+static const size_t matchLimit = 12;
+static const size_t maxOffset = 65535;
+static const int hashBits = 12;
+
+static uint32_t read32(const unsigned char* p)
+{
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint32_t hashPosition(const unsigned char* p)
+{
+	return (read32(p) * 2654435761u) >> (32 - hashBits);
+}
+
+size_t lzCompressBound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+//a length past what the token holds, 255s & then the rest
+static bool writeLength(size_t length, unsigned char*& op, const unsigned char* end)
+{
+	for (; length >= 255; length -= 255) {
+		if (op >= end)
+			return false;
+		*op++ = 255;
+	}
+	if (op >= end)
+		return false;
+	*op++ = (unsigned char)length;
+	return true;
+}
+
+//one sequence, the literals from anchor & then a match (none for the last one)
+static bool writeSequence(const unsigned char* anchor, size_t literals, size_t offset, size_t matchLength, unsigned char*& op, const unsigned char* end)
+{
+	if (op >= end)
+		return false;
+	unsigned char* token = op++;
+	*token = (unsigned char)((literals >= 15 ? 15 : literals) << 4);
+	if (literals >= 15 && !writeLength(literals - 15, op, end))
+		return false;
+	if ((size_t)(end - op) < literals)
+		return false;
+	if (literals > 0)
+		std::memcpy(op, anchor, literals);
+	op += literals;
+	if (matchLength == 0)
+		return true;
+
+	if (end - op < 2)
+		return false;
+	*op++ = (unsigned char)(offset & 0xff);
+	*op++ = (unsigned char)(offset >> 8);
+	size_t extra = matchLength - minMatch;
+	*token |= (unsigned char)(extra >= 15 ? 15 : extra);
+	return extra < 15 || writeLength(extra - 15, op, end);
+}
+
+size_t lzCompress(const unsigned char* in, size_t size, unsigned char* out, size_t capacity)
+{
+	unsigned char* op = out;
+	const unsigned char* end = out + capacity;
+	const unsigned char* anchor = in;
+	//positions + 1 so 0 means empty
+	std::vector<uint32_t> table((size_t)1 << hashBits, 0);
+
+	if (size >= matchLimit) {
+		const unsigned char* limit = in + size - matchLimit;
+		const unsigned char* matchEnd = in + size - lastLiterals;
+		for (const unsigned char* ip = in; ip <= limit;) {
+			uint32_t hash = hashPosition(ip);
+			uint32_t candidate = table[hash];
+			table[hash] = (uint32_t)(ip - in) + 1;
+			const unsigned char* match = candidate ? in + candidate - 1 : ip;
+			if (match == ip || (size_t)(ip - match) > maxOffset || read32(match) != read32(ip)) {
+				ip++;
+				continue;
+			}
+			size_t length = minMatch;
+			while (ip + length < matchEnd && match[length] == ip[length])
+				length++;
+			if (!writeSequence(anchor, (size_t)(ip - anchor), (size_t)(ip - match), length, op, end))
+				return 0;
+			ip += length;
+			anchor = ip;
+		}
+	}
+	if (!writeSequence(anchor, (size_t)(in + size - anchor), 0, 0, op, end))
+		return 0;
+	return (size_t)(op - out);
+}
+
+//the rest of a length the token maxed out
+static bool readLength(size_t& length, const unsigned char*& ip, const unsigned char* end)
+{
+	unsigned char byte;
+	do {
+		if (ip >= end)
+			return false;
+		byte = *ip++;
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+bool lzDecompress(const unsigned char* in, size_t size, unsigned char* out, size_t outSize)
+{
+	const unsigned char* ip = in;
+	const unsigned char* end = in + size;
+	unsigned char* op = out;
+	unsigned char* outEnd = out + outSize;
+	while (ip < end) {
+		unsigned char token = *ip++;
+		size_t literals = token >> 4;
+		if (literals == 15 && !readLength(literals, ip, end))
+			return false;
+		if ((size_t)(end - ip) < literals || (size_t)(outEnd - op) < literals)
+			return false;
+		if (literals > 0)
+			std::memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+		//the last sequence has no match
+		if (ip == end)
+			break;
+
+		if (end - ip < 2)
+			return false;
+		size_t offset = ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+		size_t length = token & 15;
+		if (length == 15 && !readLength(length, ip, end))
+			return false;
+		length += minMatch;
+		if (offset == 0 || offset > (size_t)(op - out) || (size_t)(outEnd - op) < length)
+			return false;
+		//the match can overlap what it's writing (a run), so byte by byte unless it's far enough back
+		const unsigned char* match = op - offset;
+		if (offset >= length) {
+			std::memcpy(op, match, length);
+			op += length;
+		}
+		else {
+			for (size_t i = 0; i < length; i++)
+				*op++ = match[i];
+		}
+	}
+	return op == outEnd;
+}
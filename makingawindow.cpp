@@ -1,4 +1,3 @@
-#define STB_IMAGE_IMPLEMENTATION
 #pragma warning(disable : 4996)
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -8,8 +7,23 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <shader.h>
+#include <glext.h>
+#include <threadpool.h>
+#include <scene.h>
+#include <profiler.h>
+#include <glstate.h>
+#include <assetpack.h>
+#ifdef GLEXP_HEADLESS
+#include <headless.h>
+#endif
 #include <filesystem>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
 
 
 //functions used later in the program for, framebuffer & getting input
@@ -17,6 +31,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 //sets up the mouse
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void pickCube(GLFWwindow* window, const Scene& scene);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 //icon image
@@ -24,20 +39,22 @@ GLFWimage iconImage; // use & to pretend it's an array of one element
 
 //Path to all relevant files
 std::filesystem::path currentPath = std::filesystem::current_path();
-std::filesystem::path vertexPath;
-std::filesystem::path fragPath;
 std::filesystem::path iconPath;
-std::filesystem::path tex1Path;
-std::filesystem::path tex2Path;
+//the asset pack to read everything from instead of the loose files ("--pack file"), relative to currentPath
+std::filesystem::path packPath;
+
+//how the scene gets built (instanced or not, how many cubes), set from the command line
+SceneOptions sceneOptions;
 
-//Vertex Array Object (i.e stores vertex attributes)
-unsigned int VAO;
+//when not 0, renders this many frames offscreen with no window & prints the frame times
+unsigned int headlessFrames = 0;
 
-//Vertex Buffer Object (stores GPU memory for the vertex shader)
-unsigned int VBO;
+//where to write a chrome trace of every profiled zone on exit, empty for none
+std::string tracePath;
 
-//Element Buffer Object (stores element array gpu memory)
-unsigned int EBO;
+//the window watches shaders/ & reloads edits unless "--no-watch", headless only with "--watch"
+bool watchShaders = false;
+bool noWatch = false;
 
 //const default screen sizes
 const unsigned int SCR_WIDTH = 800;
@@ -60,71 +77,6 @@ float pitch = 0.0f;
 float fov = 45.0f;
 
 
-//vertex data for a cube
-//first 3 values are the (x,y,z), the last 2 values are (s,t) for textures
-float vertices[] = {
-    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-};
-//EBA indices
-unsigned int indices[] = {
-    0,1,2,
-    0,2,3
-};
-
-//translation for the cube positions using vec3
-glm::vec3 cubePositions[] = {
-    glm::vec3(0.0f,  0.0f,  0.0f),
-    glm::vec3(2.0f,  5.0f, -15.0f),
-    glm::vec3(-1.5f, -2.2f, -2.5f),
-    glm::vec3(-3.8f, -2.0f, -12.3f),
-    glm::vec3(2.4f, -0.4f, -3.5f),
-    glm::vec3(-1.7f,  3.0f, -7.5f),
-    glm::vec3(1.3f, -2.0f, -2.5f),
-    glm::vec3(1.5f,  2.0f, -2.5f),
-    glm::vec3(1.5f,  0.2f, -1.5f),
-    glm::vec3(-1.3f,  1.0f, -1.5f)
-};
-
 glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
 glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
 glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
@@ -145,18 +97,190 @@ float extraTime = 0.0f;
 void preparePath() {
     // shouldn't these paths be inlined into main?
     // (i changed them from string to std::filesystem::path and moved the additional paths to here)
-    vertexPath = currentPath / "shaders/shader.vs";
-    fragPath = currentPath / "shaders/shader.fs";
-    tex1Path = currentPath / "assets/milly.png";
-    tex2Path = currentPath / "assets/boba.png";
+    // (the shaders & textures are found by the Scene from currentPath now)
     iconPath = currentPath / "assets/icon.png";
     std::cout << currentPath << '\n';
 }
 
-int main()
+//reads the command line, "--instanced" switches to the instanced path, "--cubes N" sets the cube count, "--no-cull" draws everything
+//, "--bvh" culls through the bvh, "--compact-vertices" uses half float vertices, "--texture-array" samples the cube images from one texture array, "--cpu-mips box|kaiser" builds the mip chains on the workers, "--texture-budget MiB" caps what the texture cache keeps, "--pack file" reads the shaders & images out of an asset pack, "--watch"/"--no-watch" turn shader hot reload on/off, "--headless N" renders N frames offscreen instead of opening a window & "--trace file.json" saves a chrome trace
+void parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--instanced") == 0) {
+            sceneOptions.instanced = true;
+        }
+        else if (strcmp(argv[i], "--cubes") == 0 && i + 1 < argc) {
+            sceneOptions.cubeCount = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--no-cull") == 0) {
+            sceneOptions.cull = false;
+        }
+        else if (strcmp(argv[i], "--bvh") == 0) {
+            sceneOptions.bvh = true;
+        }
+        else if (strcmp(argv[i], "--compact-vertices") == 0) {
+            sceneOptions.compactVertices = true;
+        }
+        else if (strcmp(argv[i], "--texture-array") == 0) {
+            sceneOptions.textureArray = true;
+        }
+        else if (strcmp(argv[i], "--cpu-mips") == 0 && i + 1 < argc) {
+            sceneOptions.cpuMips = true;
+            sceneOptions.mipFilter = strcmp(argv[++i], "kaiser") == 0 ? MIP_KAISER : MIP_BOX;
+        }
+        else if (strcmp(argv[i], "--texture-budget") == 0 && i + 1 < argc) {
+            sceneOptions.textureBudget = (size_t)strtoul(argv[++i], NULL, 10) << 20;
+        }
+        else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+            packPath = currentPath / argv[++i];
+        }
+        else if (strcmp(argv[i], "--watch") == 0) {
+            watchShaders = true;
+        }
+        else if (strcmp(argv[i], "--no-watch") == 0) {
+            noWatch = true;
+        }
+        else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            headlessFrames = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+            profiler.enableTrace(true);
+        }
+    }
+}
+
+//the view from the camera & the projection to go with it
+glm::mat4 cameraView() {
+    return glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+}
+glm::mat4 cameraProjection() {
+    return glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+}
+
+//prints the per zone frame time percentiles & writes the trace if one was asked for
+void reportProfile() {
+    std::cout << profiler.summary();
+    std::cout << glstate.summary();
+    if (!tracePath.empty()) {
+        if (profiler.writeChromeTrace(tracePath)) {
+            std::cout << "wrote trace to " << tracePath << std::endl;
+        }
+        else {
+            std::cout << "Failed to write trace " << tracePath << std::endl;
+        }
+    }
+}
+
+//puts the cpu & gpu frame time percentiles & the state calls the cache dropped last frame in the window title (the "overlay")
+void updateTitle(GLFWwindow* window) {
+    const TimeHistogram* cpu = profiler.histogram("frame");
+    const TimeHistogram* gpu = profiler.histogram("draw", true);
+    const GLStateStats& state = glstate.lastFrame();
+    char title[200];
+    snprintf(title, sizeof(title), ":3 UwU XD SillyWindow | cpu frame p50 %.2f p99 %.2f ms | gpu draw p50 %.2f p99 %.2f ms | gl calls %llu elided %llu",
+        cpu ? cpu->percentile(0.5) : 0.0, cpu ? cpu->percentile(0.99) : 0.0,
+        gpu ? gpu->percentile(0.5) : 0.0, gpu ? gpu->percentile(0.99) : 0.0,
+        state.totalIssued(), state.totalElided());
+    glfwSetWindowTitle(window, title);
+}
+
+#ifdef GLEXP_HEADLESS
+//renders the scene into a framebuffer object for a fixed number of frames with no window,
+//every frame is waited on with glFinish so the times include the gpu (or llvmpipe) work
+int runHeadless() {
+    if (!createHeadlessContext()) {
+        return -1;
+    }
+
+    //color & depth renderbuffers the same size as the window would be
+    unsigned int FBO, colorRBO, depthRBO;
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glGenRenderbuffers(1, &colorRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+    glGenRenderbuffers(1, &depthRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, SCR_WIDTH, SCR_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        return -1;
+    }
+    glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+
+    ThreadPool workers;
+    Shader::cacheDirectory = (currentPath / "shadercache").string();
+    sceneOptions.watchShaders = watchShaders && !noWatch;
+    Scene scene(currentPath, workers, sceneOptions);
+    //the shader & textures are in before timing starts so every frame does the same work
+    scene.finishLoading();
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(headlessFrames);
+    double drawnCubes = 0.0;
+    for (unsigned int frame = 0; frame < headlessFrames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        profiler.beginFrame();
+        glstate.beginFrame();
+        //a fixed 60fps timestep so every run animates the same
+        scene.render(cameraView(), cameraProjection(), frame / 60.0f);
+        {
+            ProfileZone zone("finish");
+            glFinish();
+        }
+        profiler.endFrame();
+        drawnCubes += scene.drawnCubes();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    //frame time statistics
+    if (!frameTimes.empty()) {
+        double total = 0.0;
+        for (double time : frameTimes) {
+            total += time;
+        }
+        std::sort(frameTimes.begin(), frameTimes.end());
+        auto percentile = [&](double p) { return frameTimes[(size_t)(p * (frameTimes.size() - 1))]; };
+        std::cout << frameTimes.size() << " frames, " << sceneOptions.cubeCount << " cubes"
+            << (sceneOptions.instanced ? ", instanced" : "") << ", " << drawnCubes / frameTimes.size() << " drawn per frame on average" << '\n';
+        std::cout << "frame ms: avg " << total / frameTimes.size() << " min " << frameTimes.front()
+            << " p50 " << percentile(0.5) << " p95 " << percentile(0.95) << " p99 " << percentile(0.99)
+            << " max " << frameTimes.back() << std::endl;
+    }
+
+    profiler.release();
+    reportProfile();
+    std::cout << scene.textureCache().summary();
+    scene.release();
+    glDeleteRenderbuffers(1, &colorRBO);
+    glDeleteRenderbuffers(1, &depthRBO);
+    glDeleteFramebuffers(1, &FBO);
+    destroyHeadlessContext();
+    return 0;
+}
+#endif
+
+int main(int argc, char** argv)
 {
     //Setting up the path
     preparePath();
+    parseArgs(argc, argv);
+    //one mapping instead of opening every file, anything missing from the pack still comes off disk
+    if (!packPath.empty() && assetPack.open(packPath.string(), currentPath.string())) {
+        std::cout << "reading " << assetPack.count() << " files from " << packPath << '\n';
+    }
+
+#ifdef GLEXP_HEADLESS
+    if (headlessFrames > 0) {
+        return runHeadless();
+    }
+#endif
+
+    //worker threads for the per frame matrix work & texture decoding
+    ThreadPool workers;
 
     //glfw initilization
     glfwInit();
@@ -183,7 +307,13 @@ int main()
     }
 
     //Sets the icon for the program
-    iconImage.pixels = stbi_load(iconPath.c_str(), &iconImage.width, &iconImage.height, 0, 4);
+    AssetSpan iconFile;
+    if (assetPack.load(iconPath.string(), iconFile)) {
+        iconImage.pixels = stbi_load_from_memory(iconFile.data, (int)iconFile.size, &iconImage.width, &iconImage.height, 0, 4);
+    }
+    else {
+        iconImage.pixels = stbi_load(iconPath.c_str(), &iconImage.width, &iconImage.height, 0, 4);
+    }
     glfwSetWindowIcon(window, 1, &iconImage);
     stbi_image_free(iconImage.pixels);
 
@@ -206,6 +336,9 @@ int main()
         std::cout << "Failed to initalize GLAD" << std::endl;
         return -1;
     }
+    //loads anything newer than 3.3 the driver has
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    std::cout << describeGLPaths();
 
     //sets the gl viewport (normalized for -1 to 1)
     glViewport(0, 0, framebufferWidth, framebufferHeight);
@@ -215,88 +348,11 @@ int main()
     glGetFloatv(GL_MAX_VERTEX_ATTRIBS, &nrAttributes);
     std::cout << "max num of vertex attributes supported: " << nrAttributes << std::endl;
 
-    //compiles the shader
-    
-    Shader ourShader(vertexPath.c_str(), fragPath.c_str());
-
-    
-    //generates a vertex attribute array
-    glGenVertexArrays(1, &VAO);
-    //Generates a vertex buffer, setting VBO as an id to it
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    
-
-    //binds the vertex array object
-    glBindVertexArray(VAO);
-    //binds the array buffer to the VBO
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    //binds ebo buffer to the EBO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    //compiles the shader (or loads it from the binary cache), makes the buffers & starts loading the textures
+    Shader::cacheDirectory = (currentPath / "shadercache").string();
+    sceneOptions.watchShaders = !noWatch;
+    Scene scene(currentPath, workers, sceneOptions);
 
-
-    //loads the vertices data into the buffer for the gpu to use
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    //loads indicies data into the ebo buffer for the gpu
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    //sets the proper attributes for the vertex data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    //enables vertex attributes
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    //--glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    //--glEnableVertexAttribArray(2);
-
-
-    //textures
-    unsigned int texture1, texture2;
-    //generates silly milly texture
-    glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(tex1Path.c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    
-    stbi_image_free(data);
-
-    //generates a texture for boba tea
-    glGenTextures(1, &texture2);
-    glBindTexture(GL_TEXTURE_2D, texture2);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    unsigned char* secondata = stbi_load(tex2Path.c_str(), &width, &height, &nrChannels, 0);
-    if (secondata) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, secondata);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else {
-        std::cout << "Failed to load texture 2" << std::endl;
-    }
-    //sets the texture uniforms
-    ourShader.use();
-    ourShader.setInt("texture1", 0);
-    ourShader.setInt("texture2", 1);
-
-    //Enables the Z-BUFFER
-    glEnable(GL_DEPTH_TEST);
-    
     // these look like one off kind of things (surely you don't have to reregister the callbacks every frame right?) (moved from processInput)
     //disables visible cursor capture
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -305,78 +361,51 @@ int main()
     //sets the scroll wheel input to its proper callback
     glfwSetScrollCallback(window, scroll_callback);
 
-    //sets & binds each of the textures
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture2);
+    float lastTitleUpdate = 0.0f;
 
     //the render loop
     while (!glfwWindowShouldClose(window))
     {
-        //swaps the rendered buffer with the next image render buffer
-        glfwSwapBuffers(window);
-        //a function to handle input
-        processInput(window);
-        //rendering commands
-        //sets the back color of the toberendered buffer to the rgba values
-        glClearColor(0.4f, 0.3f, 0.5f, 1.0f);
-        //clears it to the the color buffer (i.e. the clear color setting) & uses the z-buffer
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        profiler.beginFrame();
+        glstate.beginFrame();
+        {
+            ProfileZone zone("swap");
+            //swaps the rendered buffer with the next image render buffer
+            glfwSwapBuffers(window);
+        }
+        {
+            ProfileZone zone("input");
+            //a function to handle input
+            processInput(window);
+            pickCube(window, scene);
+        }
 
         //gets the deltaTime using differing times & frames
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        //uses the program
-        ourShader.use();
-
-
-        //Base mat4 coordinate transformations
-        glm::mat4 view;
-        glm::mat4 projection;
-
-        view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-
-        //sets the value for each mat4 transformation in coordinate spaces
-        projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
-        
-        //model render loop
-        for (unsigned int i = 0; i < 10; i++) {
-
-            glm::mat4 model = glm::mat4(1.0f);
-
-            float amountRotatedAngle = -10.0f * i;
-            float deltaRotatedAngle = 10.0f + (i * 100);
-
-
-            model = glm::translate(model, cubePositions[i]);
-            model = glm::rotate(model, glm::radians(amountRotatedAngle), glm::vec3(1.0f, 0.3f, 0.5f));
-
-
-            //rotates the local space by 50 rads over time
-            model = glm::rotate(model, ((float)glfwGetTime() + extraTime) * glm::radians(deltaRotatedAngle), glm::vec3(0.5f, 1.0f, 0.0f));
-
-            ourShader.setMat4("model", model);
+        //rendering commands
+        scene.render(cameraView(), cameraProjection(), (float)glfwGetTime() + extraTime);
 
-            //draws vertexs from the VAO that pulls each vertex point to draw,
-            //and draws each VAO as an element of a triangle
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+        {
+            ProfileZone zone("input");
+            //checks if any events were triggered (i.e. input from kb&m)
+            glfwPollEvents();
         }
-        //--glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        profiler.endFrame();
 
-        //checks if any events were triggered (i.e. input from kb&m)
-        glfwPollEvents();
+        //shows the frame times in the title about once a second
+        if (currentFrame - lastTitleUpdate > 1.0f) {
+            lastTitleUpdate = currentFrame;
+            updateTitle(window);
+        }
     }
     //delete the unused arrays
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO); // does this need to be freed?
-    //glDeleteProgram(shaderProgram); // shaderProgram is never initialized
+    profiler.release();
+    reportProfile();
+    std::cout << scene.textureCache().summary();
+    scene.release();
 
     //ends the glfw library
     glfwTerminate();
@@ -393,10 +422,10 @@ void processInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
     if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glstate.polygonMode(GL_FILL);
     }
     if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        glstate.polygonMode(GL_LINE);
     }
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
         cameraPos += cameraSpeed * cameraFront;
@@ -423,6 +452,21 @@ void processInput(GLFWwindow* window) {
         extraTime -= 6 * deltaTime;
     }
 }
+//left click picks the cube under the crosshair, the cursor is captured so the
+//pick ray is just the camera's front (what mouse_callback steers)
+void pickCube(GLFWwindow* window, const Scene& scene) {
+    static bool wasPressed = false;
+    bool pressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    if (pressed && !wasPressed) {
+        float distance;
+        int cube = scene.pick(cameraPos, cameraFront, distance);
+        if (cube >= 0)
+            std::cout << "picked cube " << cube << " at " << distance << '\n';
+        else
+            std::cout << "picked nothing\n";
+    }
+    wasPressed = pressed;
+}
 //handles mouse input functionality
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     //captures the offset of the mouse's position
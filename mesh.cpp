@@ -0,0 +1,207 @@
+#include "mesh.h"
+#include "hash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+std::vector<uint16_t> IndexedMesh::shortIndexData() const
+{
+	return std::vector<uint16_t>(indices.begin(), indices.end());
+}
+
+IndexedMesh buildIndexedMesh(const float* vertices, size_t vertexCount, unsigned int stride)
+{
+	IndexedMesh mesh = weldVertices(vertices, vertexCount, stride);
+	optimizeVertexCache(mesh.indices, mesh.vertexCount());
+	optimizeVertexFetch(mesh);
+	return mesh;
+}
+
+IndexedMesh weldVertices(const float* vertices, size_t vertexCount, unsigned int stride)
+{
+	IndexedMesh mesh;
+	mesh.stride = stride;
+	mesh.indices.resize(vertexCount);
+	size_t vertexSize = stride * sizeof(float);
+
+	//open addressing table of unique vertex indices keyed by the hash of their bytes, kept under half full
+	size_t tableSize = 16;
+	while (tableSize < vertexCount * 2)
+		tableSize *= 2;
+	std::vector<uint32_t> table(tableSize, UINT32_MAX);
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		const float* vertex = vertices + i * stride;
+		size_t slot = (size_t)hashBytes(vertex, vertexSize) & (tableSize - 1);
+		while (table[slot] != UINT32_MAX && memcmp(&mesh.vertices[table[slot] * stride], vertex, vertexSize) != 0)
+			slot = (slot + 1) & (tableSize - 1);
+		if (table[slot] == UINT32_MAX) {
+			table[slot] = (uint32_t)mesh.vertexCount();
+			mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + stride);
+		}
+		mesh.indices[i] = table[slot];
+	}
+	return mesh;
+}
+
+namespace {
+
+const int cacheSize = 32;
+
+//forsyth's scoring, vertices just used score a flat 0.75 (so a triangle doesn't win by
+//reusing the last one's edge alone), older cache entries fall off with the power curve
+//& vertices with few triangles left get a boost so they're finished off rather than stranded
+float vertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+	if (remainingTriangles == 0)
+		return -1.0f;
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.0f - (float)(cachePosition - 3) / (cacheSize - 3), 1.5f);
+	}
+	return score + 2.0f / std::sqrt((float)remainingTriangles);
+}
+
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	//vertex -> triangles adjacency as offsets into one array
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t index : indices)
+		remaining[index]++;
+	std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		adjacencyStart[v + 1] = adjacencyStart[v] + remaining[v];
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+			adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> score(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		score[v] = vertexScore(-1, remaining[v]);
+	std::vector<float> triangleScore(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++)
+		triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+	std::vector<bool> emitted(triangleCount, false);
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	//3 spare slots for the vertices pushed in before the ones falling off are trimmed
+	uint32_t cache[cacheSize + 3];
+	int cacheCount = 0;
+	size_t scanFrom = 0;
+
+	//the first triangle is just the best scoring one overall
+	size_t best = 0;
+	for (size_t t = 1; t < triangleCount; t++) {
+		if (triangleScore[t] > triangleScore[best])
+			best = t;
+	}
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+		const uint32_t* triangle = &indices[best * 3];
+		emitted[best] = true;
+		result.insert(result.end(), triangle, triangle + 3);
+
+		//the triangle's vertices go to the front of the cache, the rest shuffle back
+		uint32_t newCache[cacheSize + 3];
+		int newCount = 0;
+		for (int k = 0; k < 3; k++) {
+			uint32_t v = triangle[k];
+			newCache[newCount++] = v;
+			//drops the triangle from the vertex's adjacency
+			uint32_t* begin = &adjacency[adjacencyStart[v]];
+			uint32_t* end = begin + remaining[v];
+			*std::find(begin, end, (uint32_t)best) = end[-1];
+			remaining[v]--;
+		}
+		for (int k = 0; k < cacheCount; k++) {
+			uint32_t v = cache[k];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				newCache[newCount++] = v;
+		}
+
+		//rescores everything that was or is in the cache & the triangles around them,
+		//the best of those is the next triangle
+		float bestScore = -1.0f;
+		bool found = false;
+		for (int k = 0; k < newCount; k++) {
+			uint32_t v = newCache[k];
+			int position = k < cacheSize ? k : -1;
+			cachePosition[v] = position;
+			score[v] = vertexScore(position, remaining[v]);
+		}
+		for (int k = 0; k < newCount; k++) {
+			uint32_t v = newCache[k];
+			for (uint32_t a = adjacencyStart[v]; a < adjacencyStart[v] + remaining[v]; a++) {
+				uint32_t t = adjacency[a];
+				float s = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+				triangleScore[t] = s;
+				if (s > bestScore) {
+					bestScore = s;
+					best = t;
+					found = true;
+				}
+			}
+		}
+		cacheCount = std::min(newCount, cacheSize);
+		memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+		//nothing in the cache has triangles left, carry on from the next unemitted one
+		if (!found) {
+			while (scanFrom < triangleCount && emitted[scanFrom])
+				scanFrom++;
+			best = scanFrom;
+		}
+	}
+	indices.swap(result);
+}
+
+void optimizeVertexFetch(IndexedMesh& mesh)
+{
+	size_t vertexCount = mesh.vertexCount();
+	std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+	std::vector<float> vertices(mesh.vertices.size());
+	uint32_t next = 0;
+	for (uint32_t& index : mesh.indices) {
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = next;
+			memcpy(&vertices[next * mesh.stride], &mesh.vertices[index * mesh.stride], mesh.stride * sizeof(float));
+			next++;
+		}
+		index = remap[index];
+	}
+	//vertices nothing indexes are dropped
+	vertices.resize(next * mesh.stride);
+	mesh.vertices.swap(vertices);
+}
+
+float averageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	if (indices.size() < 3)
+		return 0.0f;
+	//each vertex remembers when it entered the fifo, it's still in there if fewer than
+	//cacheSize misses have happened since
+	std::vector<size_t> entered(vertexCount, SIZE_MAX);
+	size_t misses = 0;
+	for (uint32_t index : indices) {
+		if (entered[index] == SIZE_MAX || misses - entered[index] >= cacheSize) {
+			entered[index] = misses;
+			misses++;
+		}
+	}
+	return (float)misses / (indices.size() / 3);
+}
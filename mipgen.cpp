@@ -0,0 +1,272 @@
+#include "mipgen.h"
+#include "simd.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+//the kaiser filter's reach either side of a texel (in texels of the smaller level) & its window shape
+static const float kaiserRadius = 2.0f;
+static const float kaiserAlpha = 4.0f;
+//the most taps a texel can take, a 3:1 odd size with the kaiser filter needs 13
+static const int maxTaps = 32;
+
+const char* mipFilterName(MipFilter filter)
+{
+	switch (filter) {
+	case MIP_BOX: return "box";
+	case MIP_KAISER: return "kaiser";
+	default: return nullptr;
+	}
+}
+
+namespace {
+//which texels of the bigger level (& how much of each) make up every texel of the smaller one along
+//one axis, width taps per texel from first on (clamped to the edge where they run off it)
+struct AxisTaps
+{
+	int width = 0;
+	std::vector<int> first;
+	std::vector<float> weights;
+};
+}
+
+//zeroth order modified bessel function of the first kind, the series converges quickly for these alphas
+static float besselI0(float x)
+{
+	float sum = 1.0f, term = 1.0f, half = x * 0.5f;
+	for (int k = 1; k < 32; k++) {
+		term *= (half / k) * (half / k);
+		sum += term;
+		if (term < sum * 1e-8f)
+			break;
+	}
+	return sum;
+}
+
+//x in texels of the smaller level
+static float kaiser(float x)
+{
+	if (std::fabs(x) >= kaiserRadius)
+		return 0.0f;
+	float t = x / kaiserRadius;
+	float window = besselI0(kaiserAlpha * std::sqrt(1.0f - t * t)) / besselI0(kaiserAlpha);
+	float px = 3.14159265f * x;
+	return (x == 0.0f ? 1.0f : std::sin(px) / px) * window;
+}
+
+static AxisTaps axisTaps(int sourceLength, int length, MipFilter filter)
+{
+	float ratio = (float)sourceLength / length;
+	std::vector<int> firsts(length);
+	std::vector<std::vector<float>> each(length);
+	for (int i = 0; i < length; i++) {
+		std::vector<float>& weights = each[i];
+		if (filter == MIP_BOX || ratio <= 1.0f) {
+			//the span of texels this one covers, on odd sizes that's 2 and a bit with the ends counting partly
+			float begin = i * ratio;
+			float end = begin + ratio;
+			firsts[i] = (int)begin;
+			for (int j = firsts[i]; j < end; j++)
+				weights.push_back((std::min(end, (float)(j + 1)) - std::max(begin, (float)j)) / ratio);
+		}
+		else {
+			//sampled at the bigger level's texel centres & normalized so flat colour stays flat
+			float centre = (i + 0.5f) * ratio;
+			float reach = kaiserRadius * ratio;
+			firsts[i] = (int)std::ceil(centre - reach - 0.5f);
+			int last = (int)std::floor(centre + reach - 0.5f);
+			float sum = 0.0f;
+			for (int j = firsts[i]; j <= last; j++) {
+				weights.push_back(kaiser((j + 0.5f - centre) / ratio));
+				sum += weights.back();
+			}
+			for (float& weight : weights)
+				weight /= sum;
+		}
+		//zero weights at the ends are wasted loads
+		while (weights.size() > 1 && weights.back() == 0.0f)
+			weights.pop_back();
+		while (weights.size() > 1 && weights.front() == 0.0f) {
+			weights.erase(weights.begin());
+			firsts[i]++;
+		}
+	}
+
+	AxisTaps taps;
+	for (const std::vector<float>& weights : each)
+		taps.width = std::max(taps.width, (int)weights.size());
+	taps.width = std::min(taps.width, maxTaps);
+	taps.first = firsts;
+	taps.weights.assign((size_t)length * taps.width, 0.0f);
+	for (int i = 0; i < length; i++)
+		for (int t = 0; t < (int)each[i].size() && t < taps.width; t++)
+			taps.weights[(size_t)i * taps.width + t] = each[i][t];
+	return taps;
+}
+
+static int clampIndex(int index, int length)
+{
+	return index < 0 ? 0 : (index >= length ? length - 1 : index);
+}
+
+//the vertical pass, each output row a weighted sum of whole input rows, width texels wide
+//(so 8 floats at a time with avx, 4 with sse & all of it in the same order as the scalar loop)
+static void filterRows(const float* source, int width, int sourceHeight, float* destination, const AxisTaps& taps, bool useSimd, size_t begin, size_t end)
+{
+	size_t floats = (size_t)width * 4;
+	for (size_t y = begin; y < end; y++) {
+		const float* weights = &taps.weights[y * taps.width];
+		const float* rows[maxTaps];
+		for (int t = 0; t < taps.width; t++)
+			rows[t] = source + (size_t)clampIndex(taps.first[y] + t, sourceHeight) * floats;
+		float* out = destination + y * floats;
+		size_t x = 0;
+#ifdef SIMD_AVAILABLE
+		if (useSimd) {
+			for (; x + simd::width <= floats; x += simd::width) {
+				simd::vfloat sum = simd::vmul(simd::vload(rows[0] + x), simd::vset(weights[0]));
+				for (int t = 1; t < taps.width; t++)
+					sum = simd::vadd(sum, simd::vmul(simd::vload(rows[t] + x), simd::vset(weights[t])));
+				simd::vstore(out + x, sum);
+			}
+		}
+#endif
+		for (; x < floats; x++) {
+			float sum = rows[0][x] * weights[0];
+			for (int t = 1; t < taps.width; t++)
+				sum += rows[t][x] * weights[t];
+			out[x] = sum;
+		}
+	}
+}
+
+//the horizontal pass, one rgba texel (a whole sse register) at a time
+static void filterColumns(const float* source, int sourceWidth, float* destination, int width, const AxisTaps& taps, bool useSimd, size_t begin, size_t end)
+{
+	for (size_t y = begin; y < end; y++) {
+		const float* in = source + y * sourceWidth * 4;
+		float* out = destination + y * width * 4;
+		for (int x = 0; x < width; x++) {
+			const float* weights = &taps.weights[(size_t)x * taps.width];
+			int first = taps.first[x];
+#ifdef SIMD_AVAILABLE
+			if (useSimd) {
+				__m128 sum = _mm_mul_ps(_mm_loadu_ps(in + clampIndex(first, sourceWidth) * 4), _mm_set1_ps(weights[0]));
+				for (int t = 1; t < taps.width; t++)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + clampIndex(first + t, sourceWidth) * 4), _mm_set1_ps(weights[t])));
+				_mm_storeu_ps(out + x * 4, sum);
+				continue;
+			}
+#endif
+			for (int c = 0; c < 4; c++) {
+				float sum = in[clampIndex(first, sourceWidth) * 4 + c] * weights[0];
+				for (int t = 1; t < taps.width; t++)
+					sum += in[clampIndex(first + t, sourceWidth) * 4 + c] * weights[t];
+				out[x * 4 + c] = sum;
+			}
+		}
+	}
+}
+
+//8 bit srgb -> linear, & linear -> 8 bit srgb through a table fine enough that the
+//rounding matches pow() everywhere but the odd value right on a boundary
+static const int srgbEncodeSize = 4096;
+struct SrgbTables
+{
+	float decode[256];
+	unsigned char encode[srgbEncodeSize];
+
+	SrgbTables()
+	{
+		for (int i = 0; i < 256; i++) {
+			float c = i / 255.0f;
+			decode[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < srgbEncodeSize; i++) {
+			float l = (float)i / (srgbEncodeSize - 1);
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			encode[i] = (unsigned char)std::min(255.0f, c * 255.0f + 0.5f);
+		}
+	}
+};
+static const SrgbTables& srgbTables()
+{
+	static const SrgbTables tables;
+	return tables;
+}
+
+static void encodeTexels(const float* linear, size_t begin, size_t end, bool srgb, bool useSimd, unsigned char* out)
+{
+	const SrgbTables& tables = srgbTables();
+	//colour channels index the srgb table (or go straight to 0-255), alpha is always straight
+	float colorScale = srgb ? (float)(srgbEncodeSize - 1) : 255.0f;
+	for (size_t i = begin; i < end; i++) {
+		int values[4];
+#ifdef SIMD_AVAILABLE
+		if (useSimd) {
+			__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(linear + i * 4), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+			v = _mm_add_ps(_mm_mul_ps(v, _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f)), _mm_set1_ps(0.5f));
+			_mm_storeu_si128((__m128i*)values, _mm_cvttps_epi32(v));
+		}
+		else
+#endif
+		{
+			for (int c = 0; c < 4; c++) {
+				float v = std::min(1.0f, std::max(0.0f, linear[i * 4 + c]));
+				values[c] = (int)(v * (c < 3 ? colorScale : 255.0f) + 0.5f);
+			}
+		}
+		for (int c = 0; c < 3; c++)
+			out[i * 4 + c] = srgb ? tables.encode[values[c]] : (unsigned char)values[c];
+		out[i * 4 + 3] = (unsigned char)values[3];
+	}
+}
+
+void generateMips(const unsigned char* rgba, int width, int height, const MipOptions& options, std::vector<MipLevel>& levels, ThreadPool* pool)
+{
+	levels.clear();
+	auto forRows = [&](size_t count, const std::function<void(size_t, size_t)>& fn) {
+		if (pool)
+			pool->parallelFor(count, 16, fn);
+		else
+			fn(0, count);
+	};
+
+	const SrgbTables& tables = srgbTables();
+	std::vector<float> current((size_t)width * height * 4);
+	for (size_t i = 0; i < current.size(); i++)
+		current[i] = options.srgb && (i & 3) != 3 ? tables.decode[rgba[i]] : rgba[i] / 255.0f;
+
+	std::vector<float> rows, next;
+	while (width > 1 || height > 1) {
+		int nextWidth = std::max(1, width / 2);
+		int nextHeight = std::max(1, height / 2);
+		AxisTaps down = axisTaps(height, nextHeight, options.filter);
+		AxisTaps across = axisTaps(width, nextWidth, options.filter);
+
+		//rows first while they're still wide, then across the (fewer) rows that are left
+		rows.resize((size_t)width * nextHeight * 4);
+		forRows(nextHeight, [&](size_t begin, size_t end) {
+			filterRows(current.data(), width, height, rows.data(), down, options.simd, begin, end);
+		});
+		next.resize((size_t)nextWidth * nextHeight * 4);
+		forRows(nextHeight, [&](size_t begin, size_t end) {
+			filterColumns(rows.data(), width, next.data(), nextWidth, across, options.simd, begin, end);
+		});
+
+		MipLevel level;
+		level.width = nextWidth;
+		level.height = nextHeight;
+		level.pixels.resize((size_t)nextWidth * nextHeight * 4);
+		forRows(nextHeight, [&](size_t begin, size_t end) {
+			encodeTexels(next.data(), begin * nextWidth, end * nextWidth, options.srgb, options.simd, level.pixels.data());
+		});
+		levels.push_back(std::move(level));
+
+		current.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+}
@@ -0,0 +1,31 @@
+#include "perframe.h"
+#include "shader.h"
+#include "glstate.h"
+
+#include <glad/glad.h>
+
+void PerFrameBuffer::create()
+{
+	//every program linked from here on gets its PerFrame block pointed at the binding
+	Shader::bindBlock("PerFrame", perFrameBinding);
+
+	glGenBuffers(1, &UBO);
+	glstate.bindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(PerFrameData), NULL, GL_DYNAMIC_DRAW);
+}
+
+void PerFrameBuffer::release()
+{
+	glstate.forgetBuffer(UBO);
+	glDeleteBuffers(1, &UBO);
+	UBO = 0;
+}
+
+void PerFrameBuffer::update(const PerFrameData& data)
+{
+	glstate.bindBuffer(GL_UNIFORM_BUFFER, UBO);
+	//orphans last frame's copy so the write doesn't wait on draws still reading it
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(PerFrameData), NULL, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(PerFrameData), &data);
+	glstate.bindBufferBase(GL_UNIFORM_BUFFER, perFrameBinding, UBO);
+}
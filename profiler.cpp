@@ -0,0 +1,211 @@
+#include "profiler.h"
+
+#include <glad/glad.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+Profiler profiler;
+
+void TimeHistogram::add(double ms)
+{
+	double us = ms * 1000.0;
+	int bucket = us <= 1.0 ? 0 : (int)(std::log2(us) * 6.0);
+	if (bucket >= bucketCount)
+		bucket = bucketCount - 1;
+	counts[bucket]++;
+	total++;
+}
+
+double TimeHistogram::percentile(double p) const
+{
+	if (total == 0)
+		return 0.0;
+	uint64_t target = (uint64_t)std::ceil(p * total);
+	uint64_t seen = 0;
+	int bucket = 0;
+	for (; bucket < bucketCount - 1; bucket++) {
+		seen += counts[bucket];
+		if (seen >= target && seen > 0)
+			break;
+	}
+	//middle of the bucket (in log space)
+	return std::exp2((bucket + 0.5) / 6.0) / 1000.0;
+}
+
+int Profiler::zoneIndex(const char* name, bool gpu)
+{
+	for (size_t i = 0; i < zones.size(); i++)
+		if (zones[i].gpu == gpu && zones[i].name == name)
+			return (int)i;
+	zones.push_back(Zone());
+	zones.back().name = name;
+	zones.back().gpu = gpu;
+	return (int)zones.size() - 1;
+}
+
+double Profiler::sinceEpoch(Clock::time_point time) const
+{
+	return std::chrono::duration<double, std::micro>(time - epoch).count();
+}
+
+void Profiler::beginFrame()
+{
+	frameStart = Clock::now();
+	//the slot about to be reused was issued gpuLatency frames ago, so it's (almost always) done
+	gpuFrame = (gpuFrame + 1) % gpuLatency;
+	collectGpuFrame(gpuFrame, false);
+}
+
+void Profiler::endFrame()
+{
+	Clock::time_point now = Clock::now();
+	double frameMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+	int frame = zoneIndex("frame", false);
+	zones[frame].frameTotal += frameMs;
+	if (tracing)
+		trace.push_back({ frame, sinceEpoch(frameStart), frameMs * 1000.0 });
+
+	//zones entered more than once a frame count as their total
+	for (Zone& zone : zones) {
+		if (!zone.gpu && zone.frameTotal > 0.0) {
+			zone.histogram.add(zone.frameTotal);
+			zone.frameTotal = 0.0;
+		}
+	}
+}
+
+void Profiler::beginZone(const char* name)
+{
+	open.push_back({ zoneIndex(name, false), Clock::now() });
+}
+
+void Profiler::endZone(const char* name)
+{
+	//usually the innermost, otherwise whichever open zone has this name
+	size_t index = open.size();
+	while (index > 0 && zones[open[index - 1].zone].name != name)
+		index--;
+	if (index == 0) {
+		if (!reportedMismatch)
+			std::cout << "ERROR::PROFILER::ZONE_NOT_OPEN " << name << std::endl;
+		reportedMismatch = true;
+		return;
+	}
+	if (index != open.size() && !reportedMismatch) {
+		std::cout << "ERROR::PROFILER::ZONE_MISMATCH ending " << name << " while "
+			<< zones[open.back().zone].name << " is open" << std::endl;
+		reportedMismatch = true;
+	}
+	OpenZone zone = open[index - 1];
+	open.erase(open.begin() + (index - 1));
+	Clock::time_point now = Clock::now();
+	double ms = std::chrono::duration<double, std::milli>(now - zone.start).count();
+	zones[zone.zone].frameTotal += ms;
+	if (tracing)
+		trace.push_back({ zone.zone, sinceEpoch(zone.start), ms * 1000.0 });
+}
+
+void Profiler::beginGpuZone(const char* name)
+{
+	if (gpuZoneOpen)
+		return;
+	unsigned int query;
+	if (freeQueries.empty()) {
+		glGenQueries(1, &query);
+	}
+	else {
+		query = freeQueries.back();
+		freeQueries.pop_back();
+	}
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	gpuFrames[gpuFrame].push_back({ query, zoneIndex(name, true), sinceEpoch(Clock::now()) });
+	gpuZoneOpen = true;
+}
+
+void Profiler::endGpuZone()
+{
+	if (!gpuZoneOpen)
+		return;
+	glEndQuery(GL_TIME_ELAPSED);
+	gpuZoneOpen = false;
+}
+
+void Profiler::collectGpuFrame(int frame, bool wait)
+{
+	std::vector<double> totals(zones.size(), 0.0);
+	for (GpuQuery& query : gpuFrames[frame]) {
+		int available = 0;
+		glGetQueryObjectiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		//a result that isn't in yet is dropped rather than waited on
+		if (available || wait) {
+			GLuint64 ns = 0;
+			glGetQueryObjectui64v(query.query, GL_QUERY_RESULT, &ns);
+			totals[query.zone] += ns / 1000000.0;
+			//gpu events go on their own row, placed where the cpu issued them
+			if (tracing)
+				trace.push_back({ query.zone, query.start, ns / 1000.0 });
+		}
+		freeQueries.push_back(query.query);
+	}
+	gpuFrames[frame].clear();
+	for (size_t i = 0; i < totals.size(); i++)
+		if (totals[i] > 0.0)
+			zones[i].histogram.add(totals[i]);
+}
+
+const TimeHistogram* Profiler::histogram(const char* name, bool gpu) const
+{
+	for (const Zone& zone : zones)
+		if (zone.gpu == gpu && zone.name == name)
+			return &zone.histogram;
+	return nullptr;
+}
+
+std::string Profiler::summary() const
+{
+	std::ostringstream out;
+	char line[160];
+	for (const Zone& zone : zones) {
+		snprintf(line, sizeof(line), "%s %-16s p50 %8.3f  p95 %8.3f  p99 %8.3f ms  (%llu frames)\n",
+			zone.gpu ? "gpu" : "cpu", zone.name.c_str(), zone.histogram.percentile(0.5), zone.histogram.percentile(0.95),
+			zone.histogram.percentile(0.99), (unsigned long long)zone.histogram.total);
+		out << line;
+	}
+	return out.str();
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+		return false;
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"cpu\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"gpu\"}}";
+	char event[256];
+	for (const TraceEvent& traceEvent : trace) {
+		const Zone& zone = zones[traceEvent.zone];
+		snprintf(event, sizeof(event), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			zone.name.c_str(), zone.gpu ? 2 : 1, traceEvent.start, traceEvent.duration);
+		file << event;
+	}
+	file << "\n]}\n";
+	return (bool)file;
+}
+
+void Profiler::release()
+{
+	if (gpuZoneOpen)
+		endGpuZone();
+	//whatever's still in flight is waited on so the last frames make it into the stats
+	for (int i = 1; i <= gpuLatency; i++)
+		collectGpuFrame((gpuFrame + i) % gpuLatency, true);
+	if (!freeQueries.empty())
+		glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	freeQueries.clear();
+}
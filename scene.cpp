@@ -0,0 +1,552 @@
+#include "scene.h"
+#include "threadpool.h"
+#include "profiler.h"
+#include "mesh.h"
+#include "glstate.h"
+#include "glext.h"
+#include "vertexformat.h"
+#include "glresources.h"
+#include "assetpack.h"
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+//vertex data for a cube
+//first 3 values are the (x,y,z), the last 2 values are (s,t) for textures
+static float vertices[] = {
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+};
+
+//translation for the cube positions using vec3
+static glm::vec3 cubePositions[] = {
+    glm::vec3(0.0f,  0.0f,  0.0f),
+    glm::vec3(2.0f,  5.0f, -15.0f),
+    glm::vec3(-1.5f, -2.2f, -2.5f),
+    glm::vec3(-3.8f, -2.0f, -12.3f),
+    glm::vec3(2.4f, -0.4f, -3.5f),
+    glm::vec3(-1.7f,  3.0f, -7.5f),
+    glm::vec3(1.3f, -2.0f, -2.5f),
+    glm::vec3(1.5f,  2.0f, -2.5f),
+    glm::vec3(1.5f,  0.2f, -1.5f),
+    glm::vec3(-1.3f,  1.0f, -1.5f)
+};
+
+//the cube's vertex layouts, the full float one matches vertices[] & the compact one
+//(--compact-vertices) is the same data in half floats, 12 bytes a vertex instead of 20
+struct CubeVertex
+{
+	glm::vec3 position;
+	glm::vec2 texCoord;
+};
+VERTEX_ATTRIBUTES(CubeVertex,
+	VERTEX_ATTRIBUTE(CubeVertex, position, 0),
+	VERTEX_ATTRIBUTE(CubeVertex, texCoord, 1));
+static_assert(sizeof(CubeVertex) == 5 * sizeof(float), "CubeVertex has to match the layout of vertices[]");
+
+struct CompactCubeVertex
+{
+	Half4 position;
+	Half2 texCoord;
+};
+VERTEX_ATTRIBUTES(CompactCubeVertex,
+	VERTEX_ATTRIBUTE(CompactCubeVertex, position, 0),
+	VERTEX_ATTRIBUTE(CompactCubeVertex, texCoord, 1));
+
+//per instance model matrices, a mat4 attribute takes 4 vec4 locations (2-5)
+struct CubeInstance
+{
+	glm::mat4 model;
+};
+INSTANCE_ATTRIBUTES(CubeInstance,
+	VERTEX_ATTRIBUTE(CubeInstance, model, 2));
+static_assert(sizeof(CubeInstance) == sizeof(glm::mat4), "the instance buffer is filled straight from the matrices");
+
+//per instance texture array layers (--texture-array), a second instance stream next to the matrices
+struct CubeMaterial
+{
+	uint32_t layers; // base | overlay << 16
+};
+INSTANCE_ATTRIBUTES(CubeMaterial,
+	VERTEX_ATTRIBUTE(CubeMaterial, layers, 6));
+
+//the cube images all go in one 512x512 class, the smaller ones padded & boba scaled down to fit,
+//clamped so the padding is never wrapped into
+static TextureArrayOptions cubeArrayOptions()
+{
+	TextureArrayOptions options;
+	options.minSize = options.maxSize = 512;
+	options.params.wrapS = options.params.wrapT = GL_CLAMP_TO_EDGE;
+	return options;
+}
+
+//flat shaded stand in for while shader.vs/fs are still compiling, same inputs & uniforms
+static const char* fallbackVertexCode = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (std140) uniform PerFrame { mat4 view; mat4 projection; mat4 viewProjection; vec3 cameraPosition; float time; };
+uniform mat4 model;
+void main()
+{
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
+}
+)";
+static const char* fallbackInstancedVertexCode = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in mat4 aModel;
+layout (std140) uniform PerFrame { mat4 view; mat4 projection; mat4 viewProjection; vec3 cameraPosition; float time; };
+void main()
+{
+    gl_Position = viewProjection * aModel * vec4(aPos, 1.0);
+}
+)";
+static const char* fallbackFragmentCode = R"(#version 330 core
+out vec4 FragColor;
+void main()
+{
+    FragColor = vec4(0.8, 0.8, 0.8, 1.0);
+}
+)";
+
+//assets/baked/<name>.btex when texturebake has made one since the image last changed & the gl can
+//sample its format, so it's mapped & uploaded compressed instead of decoded, the image itself otherwise
+//(with an asset pack open the pack's baked one is taken, packassets only packs up to date ones)
+static std::string texturePath(const std::filesystem::path& root, const char* image)
+{
+	std::filesystem::path source = root / "assets" / image;
+	std::filesystem::path baked = root / "assets/baked" / source.filename().replace_extension(".btex");
+	if (assetPack.isOpen()) {
+		BlockFormat format;
+		if (assetPack.contains(baked.string()) && BakedTexture::peekFormat(baked.string(), format) && TextureLoader::bakedFormatSupported(format))
+			return baked.string();
+		return source.string();
+	}
+	std::error_code error;
+	auto bakedTime = std::filesystem::last_write_time(baked, error);
+	if (error || bakedTime < std::filesystem::last_write_time(source, error))
+		return source.string();
+	BlockFormat format;
+	if (!BakedTexture::peekFormat(baked.string(), format) || !TextureLoader::bakedFormatSupported(format))
+		return source.string();
+	return baked.string();
+}
+
+Scene::Scene(const std::filesystem::path& root, ThreadPool& workers, const SceneOptions& options)
+	: sceneOptions(options),
+	workers(workers),
+	shaders((root / "shaders/shader.vs").string().c_str(), (root / "shaders/shader.fs").string().c_str(), { "INSTANCED", "TEXTURE_MIX", "ALPHA_TEST", "TEXTURE_ARRAY" }),
+	textureLoader(workers),
+	cache(textureLoader, options.textureBudget),
+	textureArrays(workers, cubeArrayOptions())
+{
+	//registers the PerFrame block binding before anything links
+	perFrame.create();
+
+	//the variant this scene draws with compiles in the background while the rest gets set up,
+	//frames use the tiny fallback until it's ready (see activeShader)
+	shaderMask = shaders.keyword("TEXTURE_MIX");
+	if (options.instanced)
+		shaderMask |= shaders.keyword("INSTANCED");
+	if (options.textureArray)
+		shaderMask |= shaders.keyword("TEXTURE_ARRAY");
+	shaders.prepare(shaderMask);
+	if (options.watchShaders) {
+		shaderWatcher.reset(new FileWatcher());
+		for (const std::string& path : shaderSources.paths())
+			shaderWatcher->watch(path);
+	}
+	fallbackShader.submitSource(options.instanced ? fallbackInstancedVertexCode : fallbackVertexCode, fallbackFragmentCode);
+	fallbackShader.finish();
+
+	prepareCubes();
+	prepareTransforms();
+	prepareTree();
+	prepareBuffers();
+	prepareTextures(root);
+
+	//Enables the Z-BUFFER
+	glstate.setDepthTest(true);
+}
+
+//fills in the cube list, extra cubes are scattered in a box that grows with the count
+//so the density stays about the same as the original 10
+void Scene::prepareCubes()
+{
+	unsigned int cubeCount = sceneOptions.cubeCount;
+	cubes.assign(std::begin(cubePositions), std::end(cubePositions));
+	if (cubeCount < cubes.size()) {
+		cubes.resize(cubeCount);
+		return;
+	}
+	float spread = 4.0f * std::cbrt((float)cubeCount / 10.0f);
+	std::mt19937 rng(1234); // fixed seed so benchmark runs match
+	std::uniform_real_distribution<float> xy(-spread, spread);
+	std::uniform_real_distribution<float> z(-4.0f * spread, 0.0f);
+	while (cubes.size() < cubeCount) {
+		cubes.push_back(glm::vec3(xy(rng), xy(rng), z(rng)));
+	}
+}
+
+//sets up every cube's animation, a fixed tilt plus a spin that speeds up with the index
+void Scene::prepareTransforms()
+{
+	cubeTransforms.clear();
+	cubeTransforms.reserve(cubes.size());
+	for (unsigned int i = 0; i < cubes.size(); i++) {
+		float amountRotatedAngle = -10.0f * i;
+		float deltaRotatedAngle = 10.0f + (i * 100);
+		cubeTransforms.add(cubes[i], glm::vec3(1.0f, 0.3f, 0.5f), glm::radians(amountRotatedAngle),
+			glm::vec3(0.5f, 1.0f, 0.0f), glm::radians(deltaRotatedAngle));
+		//half the cube's diagonal, covers it however it's rotated
+		cubeBounds.add(cubes[i], 0.8660254f);
+	}
+	instanceMatrices.resize(cubes.size());
+	visibleCubes.resize(cubes.size());
+}
+
+//the cubes never move, so the tree is built once up front
+void Scene::prepareTree()
+{
+	BoxSet boxes;
+	for (const glm::vec3& cube : cubes)
+		boxes.add(cube, glm::vec3(0.8660254f));
+	cubeTree.build(boxes);
+}
+
+int Scene::pick(const glm::vec3& origin, const glm::vec3& direction, float& distance) const
+{
+	uint32_t hit;
+	if (!cubeTree.raycast(origin, direction, 100.0f, hit, distance))
+		return -1;
+	return (int)hit;
+}
+
+void Scene::prepareBuffers()
+{
+	//the vertex array, vertex, index & instance buffers are created & filled without binding anything
+	//when the driver has DSA (see glresources.h), otherwise through the usual bind to edit calls
+
+	//welds the 36 expanded vertices down to the unique ones & indexes them,
+	//so each corner is only transformed once per face instead of once per triangle
+	IndexedMesh cube = buildIndexedMesh(vertices, sizeof(vertices) / (5 * sizeof(float)), 5);
+	cubeIndexCount = (unsigned int)cube.indexCount();
+
+	//Vertex Array Object (stores the vertex attributes)
+	VAO = createVertexArray();
+	//loads the vertices data into the buffer for the gpu to use
+	std::vector<CompactCubeVertex> compact;
+	if (sceneOptions.compactVertices) {
+		compact.resize(cube.vertexCount());
+		for (size_t i = 0; i < compact.size(); i++) {
+			const float* v = &cube.vertices[i * cube.stride];
+			compact[i].position = packHalf4(glm::vec4(v[0], v[1], v[2], 1.0f));
+			compact[i].texCoord = packHalf2(glm::vec2(v[3], v[4]));
+		}
+		VBO = createStaticBuffer(compact.size() * sizeof(CompactCubeVertex), compact.data());
+	}
+	else {
+		VBO = createStaticBuffer(cube.vertexBytes(), cube.vertices.data());
+	}
+	//loads indicies data into the ebo buffer for the gpu
+	if (cube.shortIndices()) {
+		cubeIndexType = GL_UNSIGNED_SHORT;
+		EBO = createStaticBuffer(cube.indexBytes(), cube.shortIndexData().data());
+	}
+	else {
+		cubeIndexType = GL_UNSIGNED_INT;
+		EBO = createStaticBuffer(cube.indexBytes(), cube.indices.data());
+	}
+	setIndexBuffer(VAO, EBO);
+
+	//the divisor of 1 on the instance stream steps the matrices once per cube instead of once per vertex
+	//(the persistent ring needs base instance to point the draw at this frame's part of it)
+	instanceStream.create(GL_ARRAY_BUFFER, cubes.size() * sizeof(CubeInstance), glext.persistentStreaming());
+	//the cube's vertices & the instances are two streams of the one vao
+	if (!sceneOptions.textureArray) {
+		if (sceneOptions.compactVertices)
+			setupVertexStreams<CompactCubeVertex, CubeInstance>(VAO, { VBO, instanceStream.id() });
+		else
+			setupVertexStreams<CubeVertex, CubeInstance>(VAO, { VBO, instanceStream.id() });
+		return;
+	}
+	//& the layers are a third, stepping with the matrices (so it has to be a ring exactly when they are,
+	//base instance moves both streams)
+	materialStream.create(GL_ARRAY_BUFFER, cubes.size() * sizeof(CubeMaterial), instanceStream.persistent());
+	if (sceneOptions.compactVertices)
+		setupVertexStreams<CompactCubeVertex, CubeInstance, CubeMaterial>(VAO, { VBO, instanceStream.id(), materialStream.id() });
+	else
+		setupVertexStreams<CubeVertex, CubeInstance, CubeMaterial>(VAO, { VBO, instanceStream.id(), materialStream.id() });
+}
+
+void Scene::prepareTextures(const std::filesystem::path& root)
+{
+	if (sceneOptions.textureArray) {
+		//one layer per image, the cubes take turns at which pair they mix
+		for (const char* image : { "assets/milly.png", "assets/boba.png", "assets/icon.png" }) {
+			TextureLayer layer;
+			if (textureArrays.add((root / image).string(), layer))
+				layers.push_back(layer);
+		}
+		textureArrays.build();
+		cubeMaterials.resize(cubes.size());
+		unsigned int layerCount = (unsigned int)layers.size();
+		for (unsigned int i = 0; i < cubes.size() && layerCount > 0; i++)
+			cubeMaterials[i] = layers[i % layerCount].layer | (layers[(i + 1) % layerCount].layer << 16);
+		return;
+	}
+
+	//textures, decoded (or mapped when they've been baked) on the workers & uploaded a few per frame
+	//in render (they show up white until then)
+	TextureParams millyParams;
+	millyParams.wrapS = millyParams.wrapT = GL_MIRRORED_REPEAT;
+	millyParams.magFilter = GL_NEAREST_MIPMAP_LINEAR;
+	millyParams.minFilter = GL_NEAREST;
+	millyParams.cpuMips = sceneOptions.cpuMips;
+	millyParams.mipFilter = sceneOptions.mipFilter;
+	//generates silly milly texture
+	texture1 = cache.acquire(texturePath(root, "milly.png"), millyParams);
+
+	TextureParams bobaParams = millyParams;
+	bobaParams.wrapS = bobaParams.wrapT = GL_CLAMP_TO_EDGE;
+	//generates a texture for boba tea
+	texture2 = cache.acquire(texturePath(root, "boba.png"), bobaParams);
+}
+
+Shader& Scene::activeShader()
+{
+	//the first frame the real shader is done it takes over (unless it failed to link)
+	Shader* active = shaders.tryGet(shaderMask);
+	if (!active)
+		active = &fallbackShader;
+	if (active != currentShader || active->ID != currentProgram) {
+		currentShader = active;
+		currentProgram = active->ID;
+		//looks up the per frame uniforms once instead of every draw
+		modelLoc = active->uniform("model");
+		//sets the texture uniforms
+		active->use();
+		active->setInt("texture1", 0);
+		active->setInt("texture2", 1);
+		if (sceneOptions.textureArray) {
+			layersLoc = active->uniform("layers");
+			active->setInt("textures", 0);
+			for (const TextureLayer& layer : layers)
+				active->setVec2("layerScale[" + std::to_string(layer.layer) + "]", layer.uvScale);
+		}
+	}
+	return *active;
+}
+
+void Scene::reloadShaders()
+{
+	if (!shaderWatcher)
+		return;
+	std::vector<std::string> changed = shaderWatcher->changes();
+	if (!changed.empty()) {
+		for (const std::string& path : changed)
+			shaderSources.reload(path);
+		size_t rebuilding = shaders.reload(changed);
+		//the variants were the only sources into the old text & have just been expanded again
+		shaderSources.releaseRetired();
+		//a new #include gets watched too
+		for (const std::string& path : shaderSources.paths())
+			shaderWatcher->watch(path);
+		std::cout << "shader files changed, rebuilding " << rebuilding << " variant(s)" << std::endl;
+	}
+	if (size_t swapped = shaders.update())
+		std::cout << "swapped in " << swapped << " rebuilt variant(s)" << std::endl;
+}
+
+void Scene::finishLoading()
+{
+	shaders.get(shaderMask);
+	textureLoader.finish();
+	cache.update();
+	textureArrays.finish();
+}
+
+void Scene::render(const glm::mat4& view, const glm::mat4& projection, float time)
+{
+	//before anything's drawn so the whole frame uses one program
+	reloadShaders();
+
+	{
+		GpuProfileZone gpuZone("clear");
+		//sets the back color of the toberendered buffer to the rgba values
+		glClearColor(0.4f, 0.3f, 0.5f, 1.0f);
+		//clears it to the the color buffer (i.e. the clear color setting) & uses the z-buffer
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	{
+		ProfileZone zone("texture upload");
+		//uploads any textures the workers finished decoding
+		textureLoader.update();
+		cache.update();
+		textureArrays.update();
+	}
+
+	Shader& active = activeShader();
+	{
+		ProfileZone zone("uniform upload");
+		//uses the program
+		active.use();
+		//the camera goes through the PerFrame block, once for every program
+		PerFrameData frame;
+		frame.view = view;
+		frame.projection = projection;
+		frame.viewProjection = projection * view;
+		frame.cameraPosition = glm::vec3(glm::inverse(view)[3]);
+		frame.time = time;
+		perFrame.update(frame);
+		//sets & binds each of the textures, the state cache skips it unless an upload moved them
+		if (sceneOptions.textureArray) {
+			//one array for every cube, they pick their layers
+			if (!textureArrays.arrays().empty())
+				glstate.bindTexture(0, GL_TEXTURE_2D_ARRAY, textureArrays.arrays()[0]);
+		}
+		else {
+			glstate.bindTexture(0, GL_TEXTURE_2D, texture1);
+			glstate.bindTexture(1, GL_TEXTURE_2D, texture2);
+			cache.touch(texture1);
+			cache.touch(texture2);
+		}
+	}
+
+	drawCount = cubes.size();
+	if (sceneOptions.cull) {
+		ProfileZone zone("cull");
+		Frustum frustum = Frustum::fromMatrix(projection * view);
+		if (sceneOptions.bvh)
+			drawCount = cubeTree.queryFrustum(frustum, visibleCubes.data());
+		else
+			drawCount = cullSpheres(frustum, cubeBounds, visibleCubes.data(), &workers);
+	}
+	//only the survivors get matrices, packed one after the other
+	auto computeMatrices = [&](float* out) {
+		if (sceneOptions.cull)
+			cubeTransforms.computeIndexed(time, visibleCubes.data(), drawCount, out, &workers);
+		else
+			cubeTransforms.computeModels(time, out, &workers);
+	};
+
+	glstate.bindVertexArray(VAO);
+	unsigned int cubeCount = (unsigned int)drawCount;
+	if (sceneOptions.instanced) {
+		if (cubeCount == 0)
+			return;
+		size_t instanceOffset = 0;
+		{
+			ProfileZone zone("matrix update");
+			//the workers write the matrices straight into the instance buffer & every cube is drawn in one call
+			float* mapped = (float*)instanceStream.map(cubeCount * sizeof(CubeInstance), instanceOffset);
+			if (mapped) {
+				computeMatrices(mapped);
+				instanceStream.unmap();
+			}
+			if (sceneOptions.textureArray) {
+				//lands at the same instance as the matrices, both rings step together
+				size_t materialOffset;
+				CubeMaterial* materials = (CubeMaterial*)materialStream.map(cubeCount * sizeof(CubeMaterial), materialOffset);
+				if (materials) {
+					for (unsigned int i = 0; i < cubeCount; i++)
+						materials[i].layers = cubeMaterials[sceneOptions.cull ? visibleCubes[i] : i];
+					materialStream.unmap();
+				}
+			}
+		}
+		ProfileZone zone("draw");
+		GpuProfileZone gpuZone("draw");
+		if (instanceStream.persistent())
+			glext.DrawElementsInstancedBaseInstance(GL_TRIANGLES, cubeIndexCount, cubeIndexType, 0, cubeCount, (GLuint)(instanceOffset / sizeof(CubeInstance)));
+		else
+			glDrawElementsInstanced(GL_TRIANGLES, cubeIndexCount, cubeIndexType, 0, cubeCount);
+		instanceStream.fence();
+		materialStream.fence();
+	}
+	else {
+		{
+			ProfileZone zone("matrix update");
+			computeMatrices((float*)instanceMatrices.data());
+		}
+		//the per cube model uploads are interleaved with the draws so they count as draw time
+		ProfileZone zone("draw");
+		GpuProfileZone gpuZone("draw");
+		//model render loop
+		for (unsigned int i = 0; i < cubeCount; i++) {
+			active.setMat4(modelLoc, instanceMatrices[i]);
+			if (sceneOptions.textureArray)
+				active.setInt(layersLoc, (int)cubeMaterials[sceneOptions.cull ? visibleCubes[i] : i]);
+
+			//draws the triangles the EBO indexes out of the VAO's vertices
+			glDrawElements(GL_TRIANGLES, cubeIndexCount, cubeIndexType, 0);
+		}
+	}
+}
+
+void Scene::release()
+{
+	//delete the unused arrays (forgotten by the state cache first so reused names aren't skipped)
+	glstate.forgetVertexArray(VAO);
+	for (unsigned int buffer : { VBO, EBO })
+		glstate.forgetBuffer(buffer);
+	glstate.forgetProgram(fallbackShader.ID);
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO); // does this need to be freed?
+	instanceStream.release();
+	if (sceneOptions.textureArray)
+		materialStream.release();
+	textureArrays.release();
+	for (unsigned int texture : { texture1, texture2 })
+		if (texture)
+			cache.drop(texture);
+	cache.release();
+	shaders.release();
+	glDeleteProgram(fallbackShader.ID);
+	perFrame.release();
+	textureLoader.release();
+}
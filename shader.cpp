@@ -1,220 +1,661 @@
 #include "shader.h"
+#include "hash.h"
+#include "glext.h"
+#include "glstate.h"
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
 #include <iostream>
 
+std::string Shader::cacheDirectory;
+std::vector<std::pair<std::string, unsigned int>> Shader::blockBindings;
+
+void Shader::bindBlock(const std::string& name, unsigned int binding)
+{
+	for (auto& block : blockBindings) {
+		if (block.first == name) {
+			block.second = binding;
+			return;
+		}
+	}
+	blockBindings.push_back({ name, binding });
+}
+
 //constructer to build & read the shader
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
 {
-	//retrives the vertex/fragment source code from filepath
-	std::string vertexCode;
-	std::string fragmentCode;
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
-	//ensures ifstream objects can throw exceptions
-	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	try
-	{
-		//opens the files
-		vShaderFile.open(vertexPath);
-		fShaderFile.open(fragmentPath);
-		std::stringstream vShaderStream, fShaderStream;
-		//read file's buffer content into the streams
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
-		//closes the files
-		vShaderFile.close();
-		fShaderFile.close();
-		//convert stream into text
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
-	}
-	catch (std::ifstream::failure e) {
+	submit(vertexPath, fragmentPath);
+	finish();
+}
+
+bool Shader::submit(const char* vertexPath, const char* fragmentPath)
+{
+	//the files are mapped & their #includes expanded into pieces, nothing is copied
+	ShaderSource vertexSource, fragmentSource;
+	bool found = shaderSources.load(vertexPath, vertexSource);
+	found &= shaderSources.load(fragmentPath, fragmentSource);
+	if (!found)
 		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+	return submitSource(vertexSource, fragmentSource);
+}
+
+bool Shader::submitSource(const std::string& vertexCode, const std::string& fragmentCode)
+{
+	ShaderSource vertexSource, fragmentSource;
+	vertexSource.addText(vertexCode);
+	fragmentSource.addText(fragmentCode);
+	return submitSource(vertexSource, fragmentSource);
+}
+
+bool Shader::submitSource(const ShaderSource& vertexSource, const ShaderSource& fragmentSource)
+{
+	//skips compiling altogether when this driver already linked the same sources
+	binaryPath = binaryCachePath(vertexSource, fragmentSource);
+	if (!binaryPath.empty() && loadBinary(binaryPath)) {
+		reflectUniforms();
+		linkStatus = true;
+		return true;
 	}
 
-	const char* vShaderCode = vertexCode.c_str();
-	const char* fShaderCode = fragmentCode.c_str();
+	//compile shaders, none of the status queries happen until finish so the driver
+	//can keep going (on its own threads with parallel_shader_compile) while we submit more
+
+	//vertex shader, then frag shader
+	vertexShader = compileStage(GL_VERTEX_SHADER, vertexSource);
+	fragmentShader = compileStage(GL_FRAGMENT_SHADER, fragmentSource);
+	ownsStages = true;
+
+	//making the shader program
+	ID = glCreateProgram();
+	glAttachShader(ID, vertexShader);
+	glAttachShader(ID, fragmentShader);
+	if (!binaryPath.empty())
+		glext.ProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(ID);
+
+	building = true;
+	linkStatus = false;
+	return true;
+}
 
-	//compile shaders
+unsigned int Shader::compileStage(unsigned int type, const ShaderSource& source)
+{
+	//every piece goes in as its own string so nothing gets concatenated
+	unsigned int stage = glCreateShader(type);
+	glShaderSource(stage, (GLsizei)source.count(), source.pieces(), source.lengths());
+	glCompileShader(stage);
+	return stage;
+}
+
+bool Shader::submitStages(unsigned int vertexStage, unsigned int fragmentStage)
+{
+	//no binary cache, the point is relinking quickly & the sources aren't known here
+	binaryPath.clear();
+	vertexShader = vertexStage;
+	fragmentShader = fragmentStage;
+	ownsStages = false;
 
-	unsigned int vertex, fragment;
+	ID = glCreateProgram();
+	glAttachShader(ID, vertexShader);
+	glAttachShader(ID, fragmentShader);
+	glLinkProgram(ID);
+
+	building = true;
+	linkStatus = false;
+	return true;
+}
+
+bool Shader::ready()
+{
+	if (!building)
+		return true;
+	if (glext.parallelShaderCompile) {
+		//doesn't block, the driver answers false while its threads are still busy
+		int complete = 0;
+		glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+		if (!complete)
+			return false;
+	}
+	//without the extension there's no way to ask without waiting, so the first ask finishes it
+	finish();
+	return true;
+}
+
+//prints the shader's compile log, true when it compiled
+static bool checkShader(unsigned int shader, const char* stage)
+{
 	int success;
-	char *infolog;
-
-	//vertex shader
-	vertex = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertex, 1, &vShaderCode, NULL);
-	glCompileShader(vertex);
-	//vertex compile errors
-	glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 	if (!success) {
-		std::cout << "ERROR::SHADER::VERTEX:COMPILATION_FAILED\n";
+		std::cout << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n";
 		int loglength;
-		glGetShaderiv(vertex, GL_INFO_LOG_LENGTH, &loglength);
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &loglength);
 		if (loglength > 0) {
-			infolog = (char*)malloc(loglength);
-			glGetShaderInfoLog(vertex, loglength, NULL, infolog);
+			char* infolog = (char*)malloc(loglength);
+			glGetShaderInfoLog(shader, loglength, NULL, infolog);
 			std::cout << infolog;
 			free(infolog);
 		}
 		std::cout << std::endl;
 	}
+	return success;
+}
+
+bool Shader::finish()
+{
+	if (!building)
+		return linkStatus;
+	building = false;
 
-	//frag shader
-	fragment = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragment, 1, &fShaderCode, NULL);
-	glCompileShader(fragment);
-	glGetProgramiv(fragment, GL_COMPILE_STATUS, &success); // was GL_LINK_STATUS - looks like an error
-	//frag compile errors
-	if (!success)
-	{
-		std::cout << "ERROR::PROGRAM::COMPILATION_FAILED\n";
+	//compile errors
+	checkShader(vertexShader, "VERTEX");
+	checkShader(fragmentShader, "FRAGMENT");
+
+	int success;
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	if (!success) {
+		std::cout << "ERROR:SHADER::PROGRAM::LINKING_FAILED";
 		int loglength;
-		glGetShaderiv(fragment, GL_INFO_LOG_LENGTH, &loglength);
+		glGetProgramiv(ID, GL_INFO_LOG_LENGTH, &loglength);
 		if (loglength > 0) {
-			infolog = (char*)malloc(loglength);
-			glGetShaderInfoLog(fragment, loglength, NULL, infolog);
+			char* infolog = (char*)malloc(loglength);
+			glGetProgramInfoLog(ID, loglength, NULL, infolog);
 			std::cout << infolog;
 			free(infolog);
 		}
 		std::cout << std::endl;
 	}
+	else if (!binaryPath.empty()) {
+		saveBinary(binaryPath);
+	}
+	linkStatus = success;
 
-	//making the shader program
-	ID = glCreateProgram();
-	glAttachShader(ID, vertex);
-	glAttachShader(ID, fragment);
-	glLinkProgram(ID);
+	if (ownsStages) {
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+	}
+	else {
+		//the caller keeps them for relinking, they just don't need to stay attached
+		glDetachShader(ID, vertexShader);
+		glDetachShader(ID, fragmentShader);
+	}
+	vertexShader = fragmentShader = 0;
 
+	reflectUniforms();
+	return linkStatus;
+}
+
+//header at the front of every cached program binary
+struct BinaryHeader
+{
+	char magic[4];
+	unsigned int format;
+	unsigned int length;
+};
+
+//the cache file for these sources on this driver, or "" when there's no cache to use
+std::string Shader::binaryCachePath(const ShaderSource& vertexSource, const ShaderSource& fragmentSource)
+{
+	if (cacheDirectory.empty() || !glext.programBinary)
+		return "";
+
+	//binaries are only valid for the exact driver that made them
+	uint64_t key = vertexSource.hash();
+	key = fragmentSource.hash(key);
+	for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const char* str = (const char*)glGetString(name);
+		if (str)
+			key = hashBytes(str, strlen(str), key);
+	}
+
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.bin", (unsigned long long)key);
+	return (std::filesystem::path(cacheDirectory) / fileName).string();
+}
+
+bool Shader::loadBinary(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+	std::streamoff fileSize = file.tellg();
+	file.seekg(0);
+	BinaryHeader header;
+	if (!file.read((char*)&header, sizeof(header)) || memcmp(header.magic, "GLPB", 4) != 0)
+		return false;
+	//a truncated or corrupt file is a miss, the length isn't trusted with an allocation
+	if (header.length == 0 || (std::streamoff)header.length != fileSize - (std::streamoff)sizeof(header))
+		return false;
+	std::vector<char> binary(header.length);
+	if (!file.read(binary.data(), binary.size()))
+		return false;
+
+	ID = glCreateProgram();
+	glext.ProgramBinary(ID, header.format, binary.data(), (GLsizei)binary.size());
+	int success;
 	glGetProgramiv(ID, GL_LINK_STATUS, &success);
 	if (!success) {
-		std::cout << "ERROR:SHADER::PROGRAM::LINKING_FAILED";
-		int loglength;
-		glGetShaderiv(ID, GL_INFO_LOG_LENGTH, &loglength);
-		if (loglength > 0) {
-			infolog = (char*)malloc(loglength);
-			glGetShaderInfoLog(ID, loglength, NULL, infolog);
-			std::cout << infolog;
-			free(infolog);
+		//driver update or a different gpu, fall back to compiling (which rewrites the file)
+		std::cout << "shader binary cache rejected, recompiling " << path << std::endl;
+		glDeleteProgram(ID);
+		ID = 0;
+		return false;
+	}
+	return true;
+}
+
+void Shader::saveBinary(const std::string& path)
+{
+	int length = 0;
+	glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glext.GetProgramBinary(ID, length, &length, &format, binary.data());
+
+	std::error_code error;
+	std::filesystem::create_directories(cacheDirectory, error);
+	//written to a temp file first so a crash never leaves half a binary behind
+	std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary);
+	BinaryHeader header = { { 'G', 'L', 'P', 'B' }, format, (unsigned int)length };
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), length);
+	file.close();
+	if (file)
+		std::filesystem::rename(tempPath, path, error);
+	else
+		std::filesystem::remove(tempPath, error);
+}
+
+//reads every active uniform once so the setters never have to ask the driver
+void Shader::reflectUniforms()
+{
+	uniforms.clear();
+	uniformTable.clear();
+	shadowSlots.clear();
+	shadowValues.clear();
+
+	//shared blocks first, programs that don't use one just don't have it
+	for (const auto& block : blockBindings) {
+		unsigned int index = glGetUniformBlockIndex(ID, block.first.c_str());
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(ID, index, block.second);
+	}
+
+	int count = 0;
+	int maxNameLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<char> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+	for (int i = 0; i < count; i++) {
+		int length = 0;
+		int size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(ID, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+		std::string name(nameBuffer.data(), length);
+		int location = glGetUniformLocation(ID, name.c_str());
+		//uniforms inside blocks don't have a location
+		if (location < 0)
+			continue;
+		addUniform(name, location, type, size);
+		addShadow(location, type);
+		//arrays are reported as "name[0]", make plain "name" work too
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+			std::string base = name.substr(0, name.size() - 3);
+			addUniform(base, location, type, size);
+			//the other elements get their own shadows, their locations aren't always consecutive
+			for (int element = 1; element < size; element++)
+				addShadow(glGetUniformLocation(ID, (base + "[" + std::to_string(element) + "]").c_str()), type);
 		}
-		std::cout << std::endl;
 	}
 
-	glDeleteShader(vertex);
-	glDeleteShader(fragment);
+	//open addressed table at most half full
+	size_t tableSize = 8;
+	while (tableSize < uniforms.size() * 2)
+		tableSize *= 2;
+	uniformTable.assign(tableSize, -1);
+	for (size_t i = 0; i < uniforms.size(); i++) {
+		size_t slot = uniforms[i].hash & (tableSize - 1);
+		while (uniformTable[slot] != -1)
+			slot = (slot + 1) & (tableSize - 1);
+		uniformTable[slot] = (int)i;
+	}
+}
+void Shader::addUniform(const std::string& name, int location, unsigned int type, int size)
+{
+	uniforms.push_back({ hashString(name), location, type, size, name });
+}
+int Shader::findLocation(const std::string& name) const
+{
+	if (!uniformTable.empty()) {
+		uint64_t hash = hashString(name);
+		size_t mask = uniformTable.size() - 1;
+		for (size_t slot = hash & mask; uniformTable[slot] != -1; slot = (slot + 1) & mask) {
+			const UniformInfo& info = uniforms[uniformTable[slot]];
+			if (info.hash == hash && info.name == name)
+				return info.location;
+		}
+	}
+	//array elements past [0] aren't in the table, let the driver resolve them
+	if (name.find('[') != std::string::npos)
+		return glGetUniformLocation(ID, name.c_str());
+	return -1;
+}
+UniformHandle Shader::uniform(const std::string& name) const
+{
+	UniformHandle handle;
+	handle.location = findLocation(name);
+	return handle;
 }
 //use/activate the shader
 void Shader::use()
 {
-	glUseProgram(ID);
+	glstate.useProgram(ID);
+}
+
+//how many 32 bit words a uniform of this type takes & whether they're ints, 0 for types we don't shadow
+static int uniformWords(unsigned int type, bool& integer)
+{
+	integer = false;
+	switch (type) {
+	case GL_FLOAT: return 1;
+	case GL_FLOAT_VEC2: return 2;
+	case GL_FLOAT_VEC3: return 3;
+	case GL_FLOAT_VEC4: return 4;
+	case GL_FLOAT_MAT2: return 4;
+	case GL_FLOAT_MAT3: return 9;
+	case GL_FLOAT_MAT4: return 16;
+	}
+	integer = true;
+	switch (type) {
+	case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+	case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+	case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+	case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_SAMPLER_BUFFER:
+		return 1;
+	case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 2;
+	case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 3;
+	case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: return 4;
+	}
+	return 0;
+}
+
+void Shader::addShadow(int location, unsigned int type)
+{
+	bool integer;
+	int words = uniformWords(type, integer);
+	if (location < 0 || words == 0)
+		return;
+	if ((size_t)location >= shadowSlots.size())
+		shadowSlots.resize(location + 1);
+	shadowSlots[location].offset = (int)shadowValues.size();
+	shadowSlots[location].words = words;
+	shadowValues.resize(shadowValues.size() + words);
+	//one read per uniform at link time instead of one per get
+	uint32_t* value = &shadowValues[shadowSlots[location].offset];
+	if (integer)
+		glGetUniformiv(ID, location, (int*)value);
+	else
+		glGetUniformfv(ID, location, (float*)value);
+}
+
+bool Shader::updateShadow(int location, const void* value, int words) const
+{
+	if (location < 0 || (size_t)location >= shadowSlots.size())
+		return true;
+	const ShadowSlot& slot = shadowSlots[location];
+	if (slot.words != words)
+		return true;
+	uint32_t* shadow = &shadowValues[slot.offset];
+	//bitwise so -0.0/0.0 & nans still count as a change
+	if (memcmp(shadow, value, words * sizeof(uint32_t)) == 0)
+		return false;
+	memcpy(shadow, value, words * sizeof(uint32_t));
+	return true;
+}
+
+const uint32_t* Shader::readShadow(int location, int words) const
+{
+	if (location < 0 || (size_t)location >= shadowSlots.size() || shadowSlots[location].words != words)
+		return nullptr;
+	return &shadowValues[shadowSlots[location].offset];
+}
+
+void Shader::uploadUniform(int location, unsigned int type, const uint32_t* value) const
+{
+	const float* f = (const float*)value;
+	const int* i = (const int*)value;
+	switch (type) {
+	case GL_FLOAT: glUniform1fv(location, 1, f); break;
+	case GL_FLOAT_VEC2: glUniform2fv(location, 1, f); break;
+	case GL_FLOAT_VEC3: glUniform3fv(location, 1, f); break;
+	case GL_FLOAT_VEC4: glUniform4fv(location, 1, f); break;
+	case GL_FLOAT_MAT2: glUniformMatrix2fv(location, 1, GL_FALSE, f); break;
+	case GL_FLOAT_MAT3: glUniformMatrix3fv(location, 1, GL_FALSE, f); break;
+	case GL_FLOAT_MAT4: glUniformMatrix4fv(location, 1, GL_FALSE, f); break;
+	case GL_UNSIGNED_INT: glUniform1uiv(location, 1, value); break;
+	case GL_UNSIGNED_INT_VEC2: glUniform2uiv(location, 1, value); break;
+	case GL_UNSIGNED_INT_VEC3: glUniform3uiv(location, 1, value); break;
+	case GL_UNSIGNED_INT_VEC4: glUniform4uiv(location, 1, value); break;
+	case GL_INT_VEC2: case GL_BOOL_VEC2: glUniform2iv(location, 1, i); break;
+	case GL_INT_VEC3: case GL_BOOL_VEC3: glUniform3iv(location, 1, i); break;
+	case GL_INT_VEC4: case GL_BOOL_VEC4: glUniform4iv(location, 1, i); break;
+	//ints, bools & every sampler
+	default: glUniform1iv(location, 1, i); break;
+	}
+}
+
+void Shader::copyUniforms(const Shader& from)
+{
+	use();
+	for (const UniformInfo& info : uniforms) {
+		//arrays are in the list twice ("name[0]" & "name"), the plain name walks the elements
+		if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0)
+			continue;
+		bool integer;
+		int words = uniformWords(info.type, integer);
+		//renamed, removed or changed type, the new program's own default stays
+		auto match = std::find_if(from.uniforms.begin(), from.uniforms.end(),
+			[&](const UniformInfo& other) { return other.hash == info.hash && other.name == info.name; });
+		if (words == 0 || match == from.uniforms.end() || match->type != info.type)
+			continue;
+		for (int element = 0; element < info.size && element < match->size; element++) {
+			std::string name = element == 0 ? info.name : info.name + "[" + std::to_string(element) + "]";
+			const uint32_t* value = from.readShadow(from.findLocation(name), words);
+			if (!value)
+				continue;
+			int location = element == 0 ? info.location : glGetUniformLocation(ID, name.c_str());
+			if (updateShadow(location, value, words))
+				uploadUniform(location, info.type, value);
+		}
+	}
 }
 
 // utility uniform functions
 void Shader::setBool(const std::string& name, bool value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+	setBool(UniformHandle{ findLocation(name) }, value);
 }
 void Shader::setInt(const std::string& name, int value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+	setInt(UniformHandle{ findLocation(name) }, value);
 }
 void Shader::setFloat(const std::string& name, float value) const
 {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+	setFloat(UniformHandle{ findLocation(name) }, value);
 }
 void Shader::setVec2(const std::string& name, const glm::vec2& value) const
 {
-	glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	setVec2(UniformHandle{ findLocation(name) }, value);
 }
 void Shader::setVec2(const std::string& name, float x, float y) const
 {
-	glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+	setVec2(UniformHandle{ findLocation(name) }, glm::vec2(x, y));
 }
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
-	glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	setVec3(UniformHandle{ findLocation(name) }, value);
 }
 void Shader::setVec3(const std::string& name, float x, float y, float z) const
 {
-	glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+	setVec3(UniformHandle{ findLocation(name) }, glm::vec3(x, y, z));
 }
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const
 {
-	glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	setVec4(UniformHandle{ findLocation(name) }, value);
 }
 void Shader::setVec4(const std::string& name, float x, float y, float z, float w) const
 {
-	glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+	setVec4(UniformHandle{ findLocation(name) }, glm::vec4(x, y, z, w));
 }
 void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
 {
-	glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	setMat2(UniformHandle{ findLocation(name) }, mat);
 }
 void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
 {
-	glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	setMat3(UniformHandle{ findLocation(name) }, mat);
 }
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	setMat4(UniformHandle{ findLocation(name) }, mat);
 }
 
-bool Shader::getBool(const std::string& name) 
+void Shader::setBool(UniformHandle handle, bool value) const
 {
-	bool value;
-	glGetUniformiv(ID, glGetUniformLocation(ID, name.c_str()), &(int&)value);
-	return value;
+	setInt(handle, (int)value);
+}
+void Shader::setInt(UniformHandle handle, int value) const
+{
+	if (updateShadow(handle.location, &value, 1))
+		glUniform1i(handle.location, value);
+}
+void Shader::setFloat(UniformHandle handle, float value) const
+{
+	if (updateShadow(handle.location, &value, 1))
+		glUniform1f(handle.location, value);
+}
+void Shader::setVec2(UniformHandle handle, const glm::vec2& value) const
+{
+	if (updateShadow(handle.location, &value[0], 2))
+		glUniform2fv(handle.location, 1, &value[0]);
+}
+void Shader::setVec3(UniformHandle handle, const glm::vec3& value) const
+{
+	if (updateShadow(handle.location, &value[0], 3))
+		glUniform3fv(handle.location, 1, &value[0]);
+}
+void Shader::setVec4(UniformHandle handle, const glm::vec4& value) const
+{
+	if (updateShadow(handle.location, &value[0], 4))
+		glUniform4fv(handle.location, 1, &value[0]);
+}
+void Shader::setMat2(UniformHandle handle, const glm::mat2& mat) const
+{
+	if (updateShadow(handle.location, &mat[0][0], 4))
+		glUniformMatrix2fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+void Shader::setMat3(UniformHandle handle, const glm::mat3& mat) const
+{
+	if (updateShadow(handle.location, &mat[0][0], 9))
+		glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+void Shader::setMat4(UniformHandle handle, const glm::mat4& mat) const
+{
+	if (updateShadow(handle.location, &mat[0][0], 16))
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+
+//uniforms without a shadow (unknown names, odd types) still go to the driver
+bool Shader::getBool(const std::string& name) const
+{
+	return getInt(name) != 0;
 }
-int Shader::getInt(const std::string& name) 
+int Shader::getInt(const std::string& name) const
 {
-	int value;
-	glGetUniformiv(ID, glGetUniformLocation(ID, name.c_str()), &value);
+	int location = findLocation(name);
+	int value = 0;
+	if (const uint32_t* shadow = readShadow(location, 1))
+		memcpy(&value, shadow, sizeof(value));
+	else
+		glGetUniformiv(ID, location, &value);
 	return value;
 }
-float Shader::getFloat(const std::string& name) 
+float Shader::getFloat(const std::string& name) const
 {
-	float value;
-	glGetUniformfv(ID, glGetUniformLocation(ID, name.c_str()), &value);
+	int location = findLocation(name);
+	float value = 0.0f;
+	if (const uint32_t* shadow = readShadow(location, 1))
+		memcpy(&value, shadow, sizeof(value));
+	else
+		glGetUniformfv(ID, location, &value);
 	return value;
 }
-glm::vec2 Shader::getVec2(const std::string& name) 
+glm::vec2 Shader::getVec2(const std::string& name) const
 {
+	int location = findLocation(name);
 	glm::vec2 value;
-	glGetUniformfv(ID, glGetUniformLocation(ID, name.c_str()), &value[0]);
+	if (const uint32_t* shadow = readShadow(location, 2))
+		memcpy(&value[0], shadow, sizeof(value));
+	else
+		glGetUniformfv(ID, location, &value[0]);
 	return value;
 }
-glm::vec3 Shader::getVec3(const std::string& name) 
+glm::vec3 Shader::getVec3(const std::string& name) const
 {
+	int location = findLocation(name);
 	glm::vec3 value;
-	glGetUniformfv(ID, glGetUniformLocation(ID, name.c_str()), &value[0]);
+	if (const uint32_t* shadow = readShadow(location, 3))
+		memcpy(&value[0], shadow, sizeof(value));
+	else
+		glGetUniformfv(ID, location, &value[0]);
 	return value;
 }
-glm::vec4 Shader::getVec4(const std::string& name) 
+glm::vec4 Shader::getVec4(const std::string& name) const
 {
+	int location = findLocation(name);
 	glm::vec4 value;
-	glGetUniformfv(ID, glGetUniformLocation(ID, name.c_str()), &value[0]);
+	if (const uint32_t* shadow = readShadow(location, 4))
+		memcpy(&value[0], shadow, sizeof(value));
+	else
+		glGetUniformfv(ID, location, &value[0]);
 	return value;
 }
-glm::mat2 Shader::getMat2(const std::string& name) 
+glm::mat2 Shader::getMat2(const std::string& name) const
 {
+	int location = findLocation(name);
 	glm::mat2 mat;
-	glGetUniformfv(ID, glGetUniformLocation(ID, name.c_str()), &mat[0][0]);
+	if (const uint32_t* shadow = readShadow(location, 4))
+		memcpy(&mat[0][0], shadow, sizeof(mat));
+	else
+		glGetUniformfv(ID, location, &mat[0][0]);
 	return mat;
 }
-glm::mat3 Shader::getMat3(const std::string& name) 
+glm::mat3 Shader::getMat3(const std::string& name) const
 {
+	int location = findLocation(name);
 	glm::mat3 mat;
-	glGetUniformfv(ID, glGetUniformLocation(ID, name.c_str()), &mat[0][0]);
+	if (const uint32_t* shadow = readShadow(location, 9))
+		memcpy(&mat[0][0], shadow, sizeof(mat));
+	else
+		glGetUniformfv(ID, location, &mat[0][0]);
 	return mat;
 }
-glm::mat4 Shader::getMat4(const std::string& name) 
+glm::mat4 Shader::getMat4(const std::string& name) const
 {
+	int location = findLocation(name);
 	glm::mat4 mat;
-	glGetUniformfv(ID, glGetUniformLocation(ID, name.c_str()), &mat[0][0]);
+	if (const uint32_t* shadow = readShadow(location, 16))
+		memcpy(&mat[0][0], shadow, sizeof(mat));
+	else
+		glGetUniformfv(ID, location, &mat[0][0]);
 	return mat;
 }
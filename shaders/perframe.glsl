@@ -0,0 +1,9 @@
+// camera data shared by every program, written once a frame (see perframe.h)
+layout (std140) uniform PerFrame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    float time;
+};
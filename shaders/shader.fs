@@ -4,10 +4,34 @@ out vec4 FragColor;
 in vec3 ourColor;
 in vec2 TexCoord;
 
+#ifdef TEXTURE_ARRAY
+// every cube's images are layers of the one array, picked per cube instead of bound per cube
+uniform sampler2DArray textures;
+flat in ivec2 Layers;
+in vec2 OverlayCoord;
+#else
 uniform sampler2D texture1;
+#ifdef TEXTURE_MIX
 uniform sampler2D texture2;
+#endif
+#endif
 
 void main()
 {
+#ifdef TEXTURE_ARRAY
+    vec4 base = texture(textures, vec3(TexCoord, Layers.x));
+#ifdef TEXTURE_MIX
+    FragColor = mix(base, texture(textures, vec3(OverlayCoord, Layers.y)), 0.2);
+#else
+    FragColor = base;
+#endif
+#elif defined(TEXTURE_MIX)
     FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+#else
+    FragColor = texture(texture1, TexCoord);
+#endif
+#ifdef ALPHA_TEST
+    if (FragColor.a < 0.5)
+        discard;
+#endif
 }
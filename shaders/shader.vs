@@ -1,15 +1,50 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
+#ifdef INSTANCED
+layout (location = 2) in mat4 aModel; // per instance, takes locations 2-5
+#endif
 
 out vec2 TexCoord;
 
-uniform mat4 view;
+#ifdef TEXTURE_ARRAY
+// the two layers of the texture array this cube samples, packed base | overlay << 16
+#ifdef INSTANCED
+layout (location = 6) in uint aLayers; // per instance
+#else
+uniform int layers;
+#endif
+#define MAX_TEXTURE_LAYERS 16
+// how much of each layer its image covers
+uniform vec2 layerScale[MAX_TEXTURE_LAYERS];
+
+flat out ivec2 Layers;
+out vec2 OverlayCoord;
+#endif
+
+#include "perframe.glsl"
+
+#ifndef INSTANCED
 uniform mat4 model;
-uniform mat4 projection;
+#endif
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+#ifdef INSTANCED
+    gl_Position = viewProjection * aModel * vec4(aPos, 1.0);
+#else
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
+#endif
+#ifdef TEXTURE_ARRAY
+#ifdef INSTANCED
+    uint layerPair = aLayers;
+#else
+    uint layerPair = uint(layers);
+#endif
+    Layers = ivec2(layerPair & 0xFFFFu, layerPair >> 16);
+    TexCoord = aTexCoord * layerScale[Layers.x];
+    OverlayCoord = aTexCoord * layerScale[Layers.y];
+#else
     TexCoord = aTexCoord;
+#endif
 }
@@ -0,0 +1,289 @@
+#include "shadersource.h"
+#include "hash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+ShaderSourceLoader shaderSources;
+
+void ShaderSource::add(const char* data, size_t length)
+{
+	if (length == 0)
+		return;
+	strings.push_back(data);
+	pieceLengths.push_back((int)length);
+	owned.push_back(false);
+}
+
+void ShaderSource::addText(const std::string& str)
+{
+	if (str.empty())
+		return;
+	text.push_back(str);
+	strings.push_back(text.back().data());
+	pieceLengths.push_back((int)str.size());
+	owned.push_back(true);
+}
+
+void ShaderSource::append(const ShaderSource& other)
+{
+	for (size_t i = 0; i < other.count(); i++) {
+		if (other.owned[i])
+			addText(std::string(other.strings[i], other.pieceLengths[i]));
+		else
+			add(other.strings[i], other.pieceLengths[i]);
+	}
+}
+
+ShaderSource ShaderSource::withPrelude(const std::string& prelude) const
+{
+	ShaderSource result;
+	//owned pieces are copied (like append) so the result never points into this source's text
+	auto keep = [&](const char* data, size_t length, bool copy) {
+		if (copy)
+			result.addText(std::string(data, length));
+		else
+			result.add(data, length);
+	};
+	size_t piece = 0;
+	int line = 1;
+	for (; piece < count(); piece++) {
+		const char* data = strings[piece];
+		size_t length = pieceLengths[piece];
+		const char* version = std::search(data, data + length, "#version", "#version" + 8);
+		if (version == data + length) {
+			line += (int)std::count(data, data + length, '\n');
+			keep(data, length, owned[piece]);
+			continue;
+		}
+		//splits the piece just after the #version line
+		const char* lineEnd = std::find(version, data + length, '\n');
+		size_t split = lineEnd == data + length ? length : (size_t)(lineEnd - data) + 1;
+		line += (int)std::count(data, data + split, '\n');
+		keep(data, split, owned[piece]);
+		result.addText(prelude + "#line " + std::to_string(line) + "\n");
+		keep(data + split, length - split, owned[piece]);
+		break;
+	}
+	//no #version at all, the prelude just goes first
+	if (piece == count()) {
+		ShaderSource unversioned;
+		unversioned.addText(prelude + "#line 1\n");
+		unversioned.append(*this);
+		return unversioned;
+	}
+	for (piece++; piece < count(); piece++)
+		keep(strings[piece], pieceLengths[piece], owned[piece]);
+	return result;
+}
+
+uint64_t ShaderSource::hash(uint64_t seed) const
+{
+	uint64_t key = seed;
+	for (size_t i = 0; i < count(); i++)
+		key = hashBytes(strings[i], pieceLengths[i], key);
+	return key;
+}
+
+std::string ShaderSource::str() const
+{
+	std::string code;
+	for (size_t i = 0; i < count(); i++)
+		code.append(strings[i], pieceLengths[i]);
+	return code;
+}
+
+//the quoted (or <bracketed>) name of an #include line starting at line, empty when it isn't one
+static std::string includeName(const char* line, const char* end)
+{
+	while (line < end && (*line == ' ' || *line == '\t'))
+		line++;
+	if (end - line < 8 || memcmp(line, "#include", 8) != 0)
+		return "";
+	line += 8;
+	while (line < end && (*line == ' ' || *line == '\t'))
+		line++;
+	if (line == end || (*line != '"' && *line != '<'))
+		return "";
+	char close = *line == '"' ? '"' : '>';
+	const char* nameEnd = std::find(line + 1, end, close);
+	if (nameEnd == end)
+		return "";
+	return std::string(line + 1, nameEnd);
+}
+
+ShaderSourceLoader::File* ShaderSourceLoader::open(const std::string& path)
+{
+	std::error_code error;
+	std::string key = std::filesystem::weakly_canonical(path, error).string();
+	if (error)
+		key = path;
+	auto found = files.find(key);
+	if (found != files.end())
+		return found->second.get();
+
+	std::unique_ptr<File> file(new File());
+	file->id = (int)filesById.size();
+	file->path = path;
+	file->valid = read(file.get(), true);
+	if (!file->valid)
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+	File* result = file.get();
+	files[key] = std::move(file);
+	filesById.push_back(result);
+	scan(result);
+	return result;
+}
+
+bool ShaderSourceLoader::read(File* file, bool fromPack)
+{
+	file->data = nullptr;
+	file->size = 0;
+	if (fromPack && assetPack.load(file->path, file->packed)) {
+		file->data = (const char*)file->packed.data;
+		file->size = file->packed.size;
+		return true;
+	}
+	if (!file->mapping.open(file->path))
+		return false;
+	file->data = file->mapping.data();
+	file->size = file->mapping.size();
+	return true;
+}
+
+//splits the file into runs of text around its #include lines, once per mapping
+void ShaderSourceLoader::scan(File* file)
+{
+	file->segments.clear();
+	if (!file->valid)
+		return;
+	const char* data = file->data;
+	const char* end = data + file->size;
+	const char* runStart = data;
+	int line = 1;
+	std::filesystem::path directory = std::filesystem::path(file->path).parent_path();
+	for (const char* lineStart = data; lineStart < end; line++) {
+		const char* lineEnd = std::find(lineStart, end, '\n');
+		const char* next = lineEnd == end ? end : lineEnd + 1;
+		std::string name = includeName(lineStart, lineEnd);
+		if (!name.empty()) {
+			file->segments.push_back({ runStart, (size_t)(lineStart - runStart), nullptr, 0 });
+			File* include = open((directory / name).string());
+			file->segments.push_back({ nullptr, 0, include, line + 1 });
+			runStart = next;
+		}
+		lineStart = next;
+	}
+	file->segments.push_back({ runStart, (size_t)(end - runStart), nullptr, 0 });
+}
+
+ShaderSourceLoader::File* ShaderSourceLoader::find(const std::string& path) const
+{
+	std::error_code error;
+	std::string key = std::filesystem::weakly_canonical(path, error).string();
+	if (error)
+		key = path;
+	auto found = files.find(key);
+	return found != files.end() ? found->second.get() : nullptr;
+}
+
+bool ShaderSourceLoader::reload(const std::string& path)
+{
+	File* file = find(path);
+	if (!file)
+		return false;
+	//sources already made from the old mapping may still be read (a variant compiling right now),
+	//so it's kept until clear instead of unmapped under them
+	if (file->mapping.isOpen())
+		retired.push_back(std::move(file->mapping));
+	if (!file->packed.owned.empty())
+		retiredPacked.push_back(std::move(file->packed));
+	//someone edited the loose file, the pack still has the old one
+	file->valid = read(file, false);
+	if (!file->valid)
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << file->path << std::endl;
+	scan(file);
+	return file->valid;
+}
+
+void ShaderSourceLoader::releaseRetired()
+{
+	retired.clear();
+	retiredPacked.clear();
+}
+
+bool ShaderSourceLoader::includes(const std::string& root, const std::string& path) const
+{
+	File* from = find(root);
+	File* target = find(path);
+	if (!from || !target)
+		return false;
+	//depth first over the include graph, each file visited once
+	std::vector<const File*> stack = { from };
+	std::vector<const File*> visited;
+	while (!stack.empty()) {
+		const File* file = stack.back();
+		stack.pop_back();
+		if (file == target)
+			return true;
+		if (std::find(visited.begin(), visited.end(), file) != visited.end())
+			continue;
+		visited.push_back(file);
+		for (const Segment& segment : file->segments) {
+			if (segment.include)
+				stack.push_back(segment.include);
+		}
+	}
+	return false;
+}
+
+std::vector<std::string> ShaderSourceLoader::paths() const
+{
+	std::vector<std::string> result;
+	for (const File* file : filesById)
+		result.push_back(file->path);
+	return result;
+}
+
+bool ShaderSourceLoader::expand(File* file, ShaderSource& source, std::vector<File*>& included)
+{
+	if (!file->valid)
+		return false;
+	included.push_back(file);
+	bool ok = true;
+	for (const Segment& segment : file->segments) {
+		if (!segment.include) {
+			source.add(segment.data, segment.length);
+			continue;
+		}
+		//already in this shader (or it includes itself), skipped like #pragma once
+		if (std::find(included.begin(), included.end(), segment.include) == included.end()) {
+			source.addText("#line 1 " + std::to_string(segment.include->id) + "\n");
+			ok &= expand(segment.include, source, included);
+		}
+		source.addText("#line " + std::to_string(segment.resumeLine) + " " + std::to_string(file->id) + "\n");
+	}
+	return ok;
+}
+
+bool ShaderSourceLoader::load(const std::string& path, ShaderSource& source)
+{
+	File* file = open(path);
+	std::vector<File*> included;
+	return expand(file, source, included);
+}
+
+const std::string& ShaderSourceLoader::fileName(int id) const
+{
+	static const std::string unknown = "?";
+	return id >= 0 && id < (int)filesById.size() ? filesById[id]->path : unknown;
+}
+
+void ShaderSourceLoader::clear()
+{
+	files.clear();
+	filesById.clear();
+	releaseRetired();
+}
@@ -0,0 +1,168 @@
+#include "shadervariants.h"
+#include "glstate.h"
+
+#include <iostream>
+
+ShaderVariants::ShaderVariants(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& keywords)
+	: vertexPath(vertexPath), fragmentPath(fragmentPath), keywords(keywords)
+{
+	shaderSources.load(vertexPath, vertexSource);
+	shaderSources.load(fragmentPath, fragmentSource);
+	if (keywords.size() > 64)
+		std::cout << "ERROR::SHADER::TOO_MANY_KEYWORDS only the first 64 can be used" << std::endl;
+}
+
+uint64_t ShaderVariants::keyword(const std::string& name) const
+{
+	for (size_t i = 0; i < keywords.size() && i < 64; i++) {
+		if (keywords[i] == name)
+			return 1ull << i;
+	}
+	return 0;
+}
+
+//a #define line per keyword in the mask
+std::string ShaderVariants::defines(uint64_t mask) const
+{
+	std::string text;
+	for (size_t i = 0; i < keywords.size() && i < 64; i++) {
+		if (mask & (1ull << i))
+			text += "#define " + keywords[i] + "\n";
+	}
+	return text;
+}
+
+Shader& ShaderVariants::variant(uint64_t mask)
+{
+	Variant& slot = variants[mask];
+	if (!slot.shader) {
+		slot.shader.reset(new Shader());
+		//the defines go after #version (which has to stay first), the rest are the mapped pieces,
+		//through the binary cache whether or not it's watched (reload compiles the stages it needs)
+		std::string prelude = defines(mask);
+		slot.shader->submitSource(vertexSource.withPrelude(prelude), fragmentSource.withPrelude(prelude));
+	}
+	return *slot.shader;
+}
+
+void ShaderVariants::prepare(uint64_t mask)
+{
+	variant(mask);
+}
+
+Shader* ShaderVariants::tryGet(uint64_t mask)
+{
+	Shader& shader = variant(mask);
+	if (!shader.ready() || !shader.linked())
+		return nullptr;
+	return &shader;
+}
+
+Shader& ShaderVariants::get(uint64_t mask)
+{
+	Shader& shader = variant(mask);
+	shader.finish();
+	return shader;
+}
+
+void ShaderVariants::dropPending(Variant& variant)
+{
+	if (!variant.pending)
+		return;
+	glDeleteProgram(variant.pending->ID);
+	variant.pending.reset();
+	for (int stage = 0; stage < 2; stage++) {
+		//a stage the rebuild compiled again came from newer source than the kept one, which is stale
+		//now (the file changed whether or not the link worked), so the next reload compiles it from disk
+		//instead of linking the old one against the other stage's new source (the live program
+		//keeps working, a deleted shader attached to it only goes once it's detached)
+		if (variant.pendingStages[stage] != variant.stages[stage]) {
+			glDeleteShader(variant.pendingStages[stage]);
+			glDeleteShader(variant.stages[stage]);
+			variant.stages[stage] = 0;
+		}
+		variant.pendingStages[stage] = 0;
+	}
+}
+
+size_t ShaderVariants::reload(const std::vector<std::string>& changedFiles)
+{
+	bool vertexChanged = false;
+	bool fragmentChanged = false;
+	for (const std::string& path : changedFiles) {
+		vertexChanged |= shaderSources.includes(vertexPath, path);
+		fragmentChanged |= shaderSources.includes(fragmentPath, path);
+	}
+	if (!vertexChanged && !fragmentChanged)
+		return 0;
+
+	//expanded again from the remapped files
+	if (vertexChanged) {
+		vertexSource = ShaderSource();
+		shaderSources.load(vertexPath, vertexSource);
+	}
+	if (fragmentChanged) {
+		fragmentSource = ShaderSource();
+		shaderSources.load(fragmentPath, fragmentSource);
+	}
+
+	for (auto& entry : variants) {
+		Variant& slot = entry.second;
+		//an older rebuild still compiling is out of date now
+		dropPending(slot);
+		std::string prelude = defines(entry.first);
+		//only the stages that changed (or were never kept, like ones loaded from the binary cache) compile again
+		slot.pendingStages[0] = vertexChanged || !slot.stages[0]
+			? Shader::compileStage(GL_VERTEX_SHADER, vertexSource.withPrelude(prelude)) : slot.stages[0];
+		slot.pendingStages[1] = fragmentChanged || !slot.stages[1]
+			? Shader::compileStage(GL_FRAGMENT_SHADER, fragmentSource.withPrelude(prelude)) : slot.stages[1];
+		slot.pending.reset(new Shader());
+		slot.pending->submitStages(slot.pendingStages[0], slot.pendingStages[1]);
+	}
+	return variants.size();
+}
+
+size_t ShaderVariants::update()
+{
+	size_t swapped = 0;
+	for (auto& entry : variants) {
+		Variant& slot = entry.second;
+		if (!slot.pending || !slot.pending->ready())
+			continue;
+		//the errors are already printed, the old program keeps drawing until the next save
+		if (!slot.pending->linked()) {
+			dropPending(slot);
+			continue;
+		}
+		slot.shader->finish();
+		if (slot.shader->linked())
+			slot.pending->copyUniforms(*slot.shader);
+
+		//moved into the same object so pointers to it (the scene's) stay good
+		unsigned int oldProgram = slot.shader->ID;
+		*slot.shader = std::move(*slot.pending);
+		slot.pending.reset();
+		glstate.forgetProgram(oldProgram);
+		glDeleteProgram(oldProgram);
+		for (int stage = 0; stage < 2; stage++) {
+			if (slot.stages[stage] != slot.pendingStages[stage])
+				glDeleteShader(slot.stages[stage]);
+			slot.stages[stage] = slot.pendingStages[stage];
+			slot.pendingStages[stage] = 0;
+		}
+		swapped++;
+	}
+	return swapped;
+}
+
+void ShaderVariants::release()
+{
+	for (auto& entry : variants) {
+		dropPending(entry.second);
+		glstate.forgetProgram(entry.second.shader->ID);
+		glDeleteProgram(entry.second.shader->ID);
+		for (unsigned int stage : entry.second.stages)
+			glDeleteShader(stage);
+	}
+	variants.clear();
+}
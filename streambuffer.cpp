@@ -0,0 +1,91 @@
+#include "streambuffer.h"
+#include "glext.h"
+#include "glstate.h"
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+void StreamBuffer::create(unsigned int bufferTarget, size_t bytes, bool persistentRing)
+{
+	target = bufferTarget;
+	regionBytes = bytes;
+	glGenBuffers(1, &buffer);
+	glstate.bindBuffer(target, buffer);
+
+	if (persistentRing && glext.bufferStorage) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glext.BufferStorage(target, regionBytes * regionCount, NULL, flags);
+		mapping = (unsigned char*)glMapBufferRange(target, 0, regionBytes * regionCount, flags);
+		if (mapping)
+			return;
+		//storage is immutable, so the fallback needs a fresh buffer
+		std::cout << "ERROR::STREAMBUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+		glstate.forgetBuffer(buffer);
+		glDeleteBuffers(1, &buffer);
+		glGenBuffers(1, &buffer);
+		glstate.bindBuffer(target, buffer);
+	}
+	glBufferData(target, regionBytes, NULL, GL_STREAM_DRAW);
+}
+
+void StreamBuffer::release()
+{
+	for (void*& fence : fences) {
+		if (fence)
+			glDeleteSync((GLsync)fence);
+		fence = nullptr;
+	}
+	if (mapping) {
+		glstate.bindBuffer(target, buffer);
+		glUnmapBuffer(target);
+		mapping = nullptr;
+	}
+	glstate.forgetBuffer(buffer);
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+void* StreamBuffer::map(size_t bytes, size_t& offset)
+{
+	offset = 0;
+	if (bytes > regionBytes)
+		return nullptr;
+
+	if (!mapping) {
+		glstate.bindBuffer(target, buffer);
+		//invalidating orphans last frame's storage so mapping doesn't wait on the gpu
+		return glMapBufferRange(target, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	}
+
+	region = (region + 1) % regionCount;
+	//only blocks when the gpu is a whole ring behind
+	if (fences[region]) {
+		GLsync fence = (GLsync)fences[region];
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+		glDeleteSync(fence);
+		fences[region] = nullptr;
+	}
+	offset = region * regionBytes;
+	return mapping + offset;
+}
+
+void StreamBuffer::unmap()
+{
+	//the persistent mapping is coherent, writes are already visible
+	if (mapping)
+		return;
+	glstate.bindBuffer(target, buffer);
+	glUnmapBuffer(target);
+}
+
+void StreamBuffer::fence()
+{
+	if (!mapping)
+		return;
+	//signals once the draws reading this frame's region are done, placed after them rather than
+	//at the next map because making a fence flushes everything before it (1.5ms a frame on llvmpipe)
+	if (fences[region])
+		glDeleteSync((GLsync)fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,308 @@
+#include "texturearray.h"
+#include "threadpool.h"
+#include "glstate.h"
+#include "glext.h"
+#include "assetpack.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+TextureArrayBuilder::TextureArrayBuilder(ThreadPool& pool, const TextureArrayOptions& options)
+	: pool(pool), options(options), fitted(64)
+{
+}
+
+TextureArrayBuilder::~TextureArrayBuilder()
+{
+	//workers still in flight push into this builder, drain until they're all through
+	FittedLayer layer;
+	while (pendingCount > 0) {
+		if (fitted.pop(layer))
+			pendingCount--;
+		else
+			std::this_thread::yield();
+	}
+}
+
+void TextureArrayBuilder::release()
+{
+	for (unsigned int& texture : arrayNames) {
+		glstate.forgetTexture(texture);
+		glDeleteTextures(1, &texture);
+		texture = 0;
+	}
+}
+
+void TextureArrayBuilder::fitImage(int width, int height, const TextureArrayOptions& options, int& size, int& fittedWidth, int& fittedHeight)
+{
+	int longest = std::max(width, height);
+	size = options.minSize;
+	while (size < longest && size < options.maxSize)
+		size *= 2;
+	size = std::min(size, options.maxSize);
+
+	if (options.resample) {
+		fittedWidth = fittedHeight = size;
+		return;
+	}
+	fittedWidth = width;
+	fittedHeight = height;
+	if (longest > size) {
+		//scaled down to fit keeping the aspect, never to nothing
+		float scale = (float)size / longest;
+		fittedWidth = std::max(1, std::min(size, (int)(width * scale + 0.5f)));
+		fittedHeight = std::max(1, std::min(size, (int)(height * scale + 0.5f)));
+	}
+}
+
+namespace {
+//which source pixels make up each destination pixel along one axis & how much of each
+struct AxisTaps
+{
+	int width = 0; // taps per destination pixel
+	std::vector<int> first;
+	std::vector<float> weights; // width of them per destination pixel
+};
+}
+
+static AxisTaps axisTaps(int sourceLength, int length)
+{
+	AxisTaps taps;
+	float ratio = (float)sourceLength / length;
+	taps.width = ratio > 1.0f ? (int)std::ceil(ratio) + 1 : 2;
+	taps.first.resize(length);
+	taps.weights.assign((size_t)length * taps.width, 0.0f);
+	for (int i = 0; i < length; i++) {
+		float* weights = &taps.weights[(size_t)i * taps.width];
+		if (ratio > 1.0f) {
+			//the span of source pixels this one covers, the partly covered ones at the ends count partly
+			float begin = i * ratio;
+			float end = begin + ratio;
+			int first = (int)begin;
+			taps.first[i] = first;
+			for (int t = 0; t < taps.width; t++) {
+				float low = std::max(begin, (float)(first + t));
+				float high = std::min(end, (float)(first + t + 1));
+				weights[t] = high > low ? (high - low) / ratio : 0.0f;
+			}
+		}
+		else {
+			//between the two nearest source pixel centres
+			float centre = (i + 0.5f) * ratio - 0.5f;
+			int first = (int)std::floor(centre);
+			float fraction = centre - first;
+			taps.first[i] = first;
+			weights[0] = 1.0f - fraction;
+			weights[1] = fraction;
+		}
+	}
+	return taps;
+}
+
+void TextureArrayBuilder::resample(const unsigned char* source, int sourceWidth, int sourceHeight, unsigned char* destination, int width, int height)
+{
+	AxisTaps across = axisTaps(sourceWidth, width);
+	AxisTaps down = axisTaps(sourceHeight, height);
+	auto clampIndex = [](int index, int length) { return index < 0 ? 0 : (index >= length ? length - 1 : index); };
+
+	//rows first into floats, then the columns of that
+	std::vector<float> rows((size_t)width * sourceHeight * 4);
+	for (int y = 0; y < sourceHeight; y++) {
+		const unsigned char* sourceRow = source + (size_t)y * sourceWidth * 4;
+		float* row = &rows[(size_t)y * width * 4];
+		for (int x = 0; x < width; x++) {
+			const float* weights = &across.weights[(size_t)x * across.width];
+			float sum[4] = {};
+			for (int t = 0; t < across.width; t++) {
+				if (weights[t] == 0.0f)
+					continue;
+				const unsigned char* texel = sourceRow + clampIndex(across.first[x] + t, sourceWidth) * 4;
+				for (int c = 0; c < 4; c++)
+					sum[c] += texel[c] * weights[t];
+			}
+			std::memcpy(row + x * 4, sum, sizeof(sum));
+		}
+	}
+	for (int y = 0; y < height; y++) {
+		const float* weights = &down.weights[(size_t)y * down.width];
+		unsigned char* out = destination + (size_t)y * width * 4;
+		for (int x = 0; x < width * 4; x++) {
+			float sum = 0.0f;
+			for (int t = 0; t < down.width; t++) {
+				if (weights[t] != 0.0f)
+					sum += rows[(size_t)clampIndex(down.first[y] + t, sourceHeight) * width * 4 + x] * weights[t];
+			}
+			out[x] = (unsigned char)std::min(255.0f, std::max(0.0f, sum + 0.5f));
+		}
+	}
+}
+
+bool TextureArrayBuilder::fitLayer(const std::string& path, const TextureArrayOptions& options, int size, std::vector<unsigned char>& pixels)
+{
+	pixels.assign((size_t)size * size * 4, 255);
+	DecodedImage image;
+	if (!TextureLoader::decodeFile(path, options.params.flipVertically, image)) {
+		stbi_image_free(image.pixels);
+		return false;
+	}
+
+	int layerSize, width, height;
+	fitImage(image.width, image.height, options, layerSize, width, height);
+	const unsigned char* source = image.pixels;
+	std::vector<unsigned char> scaled;
+	if (width != image.width || height != image.height) {
+		scaled.resize((size_t)width * height * 4);
+		resample(image.pixels, image.width, image.height, scaled.data(), width, height);
+		source = scaled.data();
+	}
+
+	//the image goes in the corner the texture coordinates start from, the last column & row are
+	//repeated over the padding so filtering & the smaller mips don't pull anything else into the edges
+	for (int y = 0; y < size; y++) {
+		const unsigned char* row = source + (size_t)std::min(y, height - 1) * width * 4;
+		unsigned char* out = &pixels[(size_t)y * size * 4];
+		std::memcpy(out, row, (size_t)width * 4);
+		for (int x = width; x < size; x++)
+			std::memcpy(out + x * 4, row + (width - 1) * 4, 4);
+	}
+	stbi_image_free(image.pixels);
+	return true;
+}
+
+bool TextureArrayBuilder::add(const std::string& path, TextureLayer& layer)
+{
+	//only the header is read, the decode waits for build
+	int width, height, channels;
+	AssetSpan packed;
+	bool found = assetPack.load(path, packed) ? stbi_info_from_memory(packed.data, (int)packed.size, &width, &height, &channels)
+		: stbi_info(path.c_str(), &width, &height, &channels);
+	if (!found) {
+		std::cout << "ERROR::TEXTUREARRAY::NOT_AN_IMAGE " << path << std::endl;
+		return false;
+	}
+
+	int size, fittedWidth, fittedHeight;
+	fitImage(width, height, options, size, fittedWidth, fittedHeight);
+	unsigned int array = 0;
+	while (array < classes.size() && classes[array].size != size)
+		array++;
+	if (array == classes.size()) {
+		classes.emplace_back();
+		classes.back().size = size;
+	}
+
+	layer.array = array;
+	layer.layer = (unsigned int)classes[array].paths.size();
+	layer.uvScale = glm::vec2((float)fittedWidth / size, (float)fittedHeight / size);
+	classes[array].paths.push_back(path);
+	return true;
+}
+
+void TextureArrayBuilder::createArray(SizeClass& sizeClass, unsigned int& texture)
+{
+	//every mip of every layer up front, the mips get built once all the layers are in
+	int levels = 1;
+	while ((sizeClass.size >> levels) > 0)
+		levels++;
+	GLsizei layers = (GLsizei)sizeClass.paths.size();
+	const TextureParams& params = options.params;
+
+	if (glext.directStateAccess) {
+		glext.CreateTextures(GL_TEXTURE_2D_ARRAY, 1, &texture);
+		glext.TextureParameteri(texture, GL_TEXTURE_WRAP_S, params.wrapS);
+		glext.TextureParameteri(texture, GL_TEXTURE_WRAP_T, params.wrapT);
+		glext.TextureParameteri(texture, GL_TEXTURE_MAG_FILTER, params.magFilter);
+		glext.TextureParameteri(texture, GL_TEXTURE_MIN_FILTER, params.minFilter);
+		glext.TextureStorage3D(texture, levels, GL_RGBA8, sizeClass.size, sizeClass.size, layers);
+		return;
+	}
+
+	glGenTextures(1, &texture);
+	glstate.bindTextureForEdit(GL_TEXTURE_2D_ARRAY, texture);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, params.wrapS);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, params.wrapT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, params.magFilter);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, params.minFilter);
+	if (glext.textureStorage) {
+		glext.TexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, sizeClass.size, sizeClass.size, layers);
+		return;
+	}
+	for (int level = 0; level < levels; level++) {
+		int size = std::max(1, sizeClass.size >> level);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, size, size, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+}
+
+void TextureArrayBuilder::build()
+{
+	arrayNames.resize(classes.size());
+	for (unsigned int array = 0; array < classes.size(); array++) {
+		SizeClass& sizeClass = classes[array];
+		createArray(sizeClass, arrayNames[array]);
+		sizeClass.pending = (unsigned int)sizeClass.paths.size();
+		for (unsigned int layer = 0; layer < sizeClass.paths.size(); layer++) {
+			pendingCount++;
+			std::string path = sizeClass.paths[layer];
+			int size = sizeClass.size;
+			TextureArrayOptions fit = options;
+			pool.submit([this, path, fit, size, array, layer] {
+				FittedLayer result;
+				result.array = array;
+				result.layer = layer;
+				if (!fitLayer(path, fit, size, result.pixels))
+					std::cout << "Failed to load texture " << path << std::endl;
+				//failed layers go through the queue too (white) so pending() still counts down,
+				//a full queue leaves result as it was so the retry still has the pixels
+				while (!fitted.push(std::move(result)))
+					std::this_thread::yield();
+			});
+		}
+	}
+}
+
+void TextureArrayBuilder::update(unsigned int maxUploads)
+{
+	FittedLayer layer;
+	for (unsigned int i = 0; i < maxUploads && fitted.pop(layer); i++) {
+		upload(layer);
+		pendingCount--;
+	}
+}
+
+void TextureArrayBuilder::finish()
+{
+	while (pendingCount > 0) {
+		update(~0u);
+		std::this_thread::yield();
+	}
+}
+
+void TextureArrayBuilder::upload(FittedLayer& layer)
+{
+	SizeClass& sizeClass = classes[layer.array];
+	unsigned int texture = arrayNames[layer.array];
+	int size = sizeClass.size;
+	//fitLayer always hands back a full layer (white when it failed), anything short of that is a bug upstream
+	//& gets the white too rather than glTexSubImage3D reading past it
+	if (layer.pixels.size() != (size_t)size * size * 4)
+		layer.pixels.assign((size_t)size * size * 4, 255);
+	//straight out of the worker's pixels, so nothing can be left on the unpack binding
+	glstate.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (glext.directStateAccess) {
+		glext.TextureSubImage3D(texture, 0, 0, 0, layer.layer, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, layer.pixels.data());
+		//building the mips redoes every layer, so it waits for the last one
+		if (--sizeClass.pending == 0)
+			glext.GenerateTextureMipmap(texture);
+		return;
+	}
+	//uploads happen mid frame, the draws rebind their textures through the state cache after
+	glstate.bindTextureForEdit(GL_TEXTURE_2D_ARRAY, texture);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer.layer, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, layer.pixels.data());
+	if (--sizeClass.pending == 0)
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
@@ -0,0 +1,131 @@
+#include "texturecache.h"
+#include "glstate.h"
+#include "hash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+TextureCache::TextureCache(TextureLoader& loader, size_t budgetBytes)
+	: loader(loader), budget(budgetBytes)
+{
+}
+
+void TextureCache::release()
+{
+	for (auto& pair : entries) {
+		glstate.forgetTexture(pair.second.texture);
+		glDeleteTextures(1, &pair.second.texture);
+	}
+	entries.clear();
+	keys.clear();
+	recent.clear();
+	totals.residentBytes = 0;
+}
+
+uint64_t TextureCache::key(const std::string& path, const TextureParams& params)
+{
+	//field by field, the padding in the struct isn't anything
+	uint64_t hash = hashString(path);
+	const unsigned int fields[] = { params.wrapS, params.wrapT, params.minFilter, params.magFilter, params.flipVertically,
+		params.cpuMips, (unsigned int)params.mipFilter, params.srgb };
+	return hashBytes(fields, sizeof(fields), hash);
+}
+
+TextureCache::Entry* TextureCache::find(unsigned int texture)
+{
+	auto found = keys.find(texture);
+	return found == keys.end() ? nullptr : &entries[found->second];
+}
+
+unsigned int TextureCache::acquire(const std::string& path, const TextureParams& params)
+{
+	uint64_t hash = key(path, params);
+	auto found = entries.find(hash);
+	if (found != entries.end()) {
+		if (found->second.path != path)
+			std::cout << "ERROR::TEXTURECACHE::HASH_COLLISION " << path << " & " << found->second.path << std::endl;
+		totals.hits++;
+		found->second.references++;
+		recent.splice(recent.begin(), recent, found->second.recent);
+		return found->second.texture;
+	}
+
+	totals.misses++;
+	Entry& entry = entries[hash];
+	entry.path = path;
+	entry.texture = loader.load(path, params);
+	entry.references = 1;
+	recent.push_front(hash);
+	entry.recent = recent.begin();
+	keys[entry.texture] = hash;
+	return entry.texture;
+}
+
+void TextureCache::drop(unsigned int texture)
+{
+	Entry* entry = find(texture);
+	if (!entry || entry->references == 0) {
+		std::cout << "ERROR::TEXTURECACHE::NOT_ACQUIRED " << texture << std::endl;
+		return;
+	}
+	entry->references--;
+}
+
+void TextureCache::touch(unsigned int texture)
+{
+	if (Entry* entry = find(texture))
+		recent.splice(recent.begin(), recent, entry->recent);
+}
+
+void TextureCache::update()
+{
+	for (const UploadedTexture& done : loader.uploads()) {
+		Entry* entry = find(done.texture);
+		//a texture loaded straight through the loader, not ours
+		if (!entry)
+			continue;
+		entry->loading = false;
+		entry->bytes = done.bytes;
+		totals.residentBytes += done.bytes;
+		totals.peakBytes = std::max(totals.peakBytes, totals.residentBytes);
+	}
+	evict();
+}
+
+void TextureCache::evict()
+{
+	//oldest first, skipping whatever's still referenced or loading
+	for (auto it = recent.end(); totals.residentBytes > budget && it != recent.begin();) {
+		--it;
+		Entry& entry = entries[*it];
+		if (entry.references > 0 || entry.loading)
+			continue;
+		//erasing takes its list node, hold on to the one after it so the next step lands on the newer neighbour
+		auto next = it;
+		++next;
+		erase(entry);
+		totals.evictions++;
+		it = next;
+	}
+}
+
+void TextureCache::erase(Entry& entry)
+{
+	glstate.forgetTexture(entry.texture);
+	glDeleteTextures(1, &entry.texture);
+	totals.residentBytes -= entry.bytes;
+	recent.erase(entry.recent);
+	uint64_t hash = keys[entry.texture];
+	keys.erase(entry.texture);
+	entries.erase(hash);
+}
+
+std::string TextureCache::summary() const
+{
+	char line[200];
+	snprintf(line, sizeof(line), "texture cache: %zu textures, %.1f of %.1f MiB (peak %.1f), hits %llu misses %llu evictions %llu\n",
+		entries.size(), totals.residentBytes / 1048576.0, budget / 1048576.0, totals.peakBytes / 1048576.0,
+		totals.hits, totals.misses, totals.evictions);
+	return line;
+}
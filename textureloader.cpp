@@ -0,0 +1,273 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "textureloader.h"
+#include "threadpool.h"
+#include "glstate.h"
+#include "glext.h"
+#include "assetpack.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+TextureLoader::TextureLoader(ThreadPool& pool)
+	: pool(pool), decoded(64)
+{
+	glGenBuffers(1, &unpackBuffer);
+}
+
+TextureLoader::~TextureLoader()
+{
+	//workers still in flight push into this loader, drain until they're all through
+	DecodedImage image;
+	while (pendingCount > 0) {
+		if (decoded.pop(image)) {
+			stbi_image_free(image.pixels);
+			pendingCount--;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void TextureLoader::release()
+{
+	glstate.forgetBuffer(unpackBuffer);
+	glDeleteBuffers(1, &unpackBuffer);
+	unpackBuffer = 0;
+}
+
+bool TextureLoader::decodeFile(const std::string& path, bool flipVertically, DecodedImage& image)
+{
+	//straight out of the pack's mapping when it's in there, otherwise the whole file
+	//is read up front, either way stb decodes from memory
+	AssetSpan packed;
+	std::vector<unsigned char> bytes;
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+	if (assetPack.load(path, packed)) {
+		data = packed.data;
+		size = packed.size;
+	}
+	else {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+		bytes.resize((size_t)file.tellg());
+		file.seekg(0);
+		if (!file.read((char*)bytes.data(), bytes.size()))
+			return false;
+		data = bytes.data();
+		size = bytes.size();
+	}
+
+	//the flip flag is per thread so workers don't step on each other
+	stbi_set_flip_vertically_on_load_thread(flipVertically);
+	int channels;
+	image.pixels = stbi_load_from_memory(data, (int)size, &image.width, &image.height, &channels, 4);
+	image.path = path;
+	return image.pixels != nullptr;
+}
+
+unsigned int TextureLoader::load(const std::string& path, const TextureParams& params)
+{
+	unsigned int texture;
+	if (glext.directStateAccess) {
+		//set up by name, nothing bound, the storage is made once the size is known (see upload)
+		glext.CreateTextures(GL_TEXTURE_2D, 1, &texture);
+		glext.TextureParameteri(texture, GL_TEXTURE_WRAP_S, params.wrapS);
+		glext.TextureParameteri(texture, GL_TEXTURE_WRAP_T, params.wrapT);
+		glext.TextureParameteri(texture, GL_TEXTURE_MAG_FILTER, params.magFilter);
+		glext.TextureParameteri(texture, GL_TEXTURE_MIN_FILTER, params.minFilter);
+	}
+	else {
+		glGenTextures(1, &texture);
+		//goes through the state cache so whoever draws next rebinds what they need
+		//(no glGetIntegerv round trip to save & restore the old binding)
+		glstate.bindTextureForEdit(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrapS);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrapT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.magFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.minFilter);
+		//white placeholder until the real image arrives
+		const unsigned char white[4] = { 255, 255, 255, 255 };
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+	}
+
+	pendingCount++;
+	if (std::filesystem::path(path).extension() == ".btex") {
+		pool.submit([this, path, texture] {
+			DecodedImage image;
+			image.texture = texture;
+			image.path = path;
+			//the page faults happen here rather than in the upload on the gl thread
+			image.baked.reset(new BakedTexture());
+			if (image.baked->open(path))
+				image.baked->prefetch();
+			else
+				image.baked.reset();
+			while (!decoded.push(std::move(image)))
+				std::this_thread::yield();
+		});
+		return texture;
+	}
+
+	pool.submit([this, path, params, texture] {
+		DecodedImage image;
+		if (!decodeFile(path, params.flipVertically, image)) {
+			std::cout << "Failed to load texture " << path << std::endl;
+		}
+		else if (params.cpuMips) {
+			//this job is already one of the pool's, so the levels are built right here rather than split over it
+			MipOptions mipOptions;
+			mipOptions.filter = params.mipFilter;
+			mipOptions.srgb = params.srgb;
+			generateMips(image.pixels, image.width, image.height, mipOptions, image.mips);
+		}
+		image.texture = texture;
+		//failed images go through the queue too so pending() still counts down
+		while (!decoded.push(std::move(image)))
+			std::this_thread::yield();
+	});
+	return texture;
+}
+
+void TextureLoader::update(unsigned int maxUploads)
+{
+	DecodedImage image;
+	for (unsigned int i = 0; i < maxUploads && decoded.pop(image); i++) {
+		UploadedTexture done;
+		done.texture = image.texture;
+		if (image.baked)
+			done.bytes = uploadBaked(image);
+		else if (image.pixels)
+			done.bytes = upload(image);
+		uploaded.push_back(done);
+		stbi_image_free(image.pixels);
+		image.baked.reset();
+		image.mips.clear();
+		pendingCount--;
+	}
+}
+
+std::vector<UploadedTexture> TextureLoader::uploads()
+{
+	std::vector<UploadedTexture> done;
+	done.swap(uploaded);
+	return done;
+}
+
+void TextureLoader::finish()
+{
+	while (pendingCount > 0) {
+		update(~0u);
+		std::this_thread::yield();
+	}
+}
+
+size_t TextureLoader::upload(DecodedImage& image)
+{
+	//the image & any cpu built mips one after the other
+	auto levelPixels = [&](size_t level) {
+		return level == 0 ? image.pixels : image.mips[level - 1].pixels.data();
+	};
+	auto levelBytes = [&](size_t level) {
+		return level == 0 ? (size_t)image.width * image.height * 4 : image.mips[level - 1].pixels.size();
+	};
+	std::vector<size_t> offsets(1 + image.mips.size());
+	size_t size = 0;
+	for (size_t level = 0; level < offsets.size(); level++) {
+		offsets[level] = size;
+		size += levelBytes(level);
+	}
+
+	//the copy into the orphaned unpack buffer lets the driver pull the pixels
+	//asynchronously instead of copying them out of our memory right now
+	glstate.bindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	unsigned char* mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	auto source = [&](size_t level) -> const void* {
+		return mapped ? (const void*)offsets[level] : (const void*)levelPixels(level);
+	};
+	if (mapped) {
+		for (size_t level = 0; level < offsets.size(); level++)
+			memcpy(mapped + offsets[level], levelPixels(level), levelBytes(level));
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+	else {
+		glstate.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	//rgba8 all the way down to 1x1, whoever builds the levels
+	int levels = 1;
+	size_t bytes = (size_t)image.width * image.height * 4;
+	while ((image.width >> levels) > 0 || (image.height >> levels) > 0) {
+		bytes += (size_t)std::max(1, image.width >> levels) * std::max(1, image.height >> levels) * 4;
+		levels++;
+	}
+
+	bool cpuMips = !image.mips.empty();
+	if (glext.directStateAccess) {
+		//immutable storage with the whole mip chain, filled by name so the draws' bindings are left alone
+		glext.TextureStorage2D(image.texture, levels, GL_RGBA8, image.width, image.height);
+		glext.TextureSubImage2D(image.texture, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, source(0));
+		for (size_t level = 0; level < image.mips.size(); level++)
+			glext.TextureSubImage2D(image.texture, (GLint)level + 1, 0, 0, image.mips[level].width, image.mips[level].height, GL_RGBA, GL_UNSIGNED_BYTE, source(level + 1));
+		if (!cpuMips)
+			glext.GenerateTextureMipmap(image.texture);
+	}
+	else {
+		//uploads happen mid frame, the draws rebind their textures through the state cache after
+		glstate.bindTextureForEdit(GL_TEXTURE_2D, image.texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, source(0));
+		for (size_t level = 0; level < image.mips.size(); level++)
+			glTexImage2D(GL_TEXTURE_2D, (GLint)level + 1, GL_RGBA, image.mips[level].width, image.mips[level].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, source(level + 1));
+		if (!cpuMips)
+			glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	glstate.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	return bytes;
+}
+
+bool TextureLoader::bakedFormatSupported(BlockFormat format)
+{
+	if (format == BLOCK_BC7)
+		return glext.textureCompressionBPTC;
+	return glext.textureCompressionS3TC;
+}
+
+size_t TextureLoader::uploadBaked(DecodedImage& image)
+{
+	const BakedTexture& baked = *image.baked;
+	if (!bakedFormatSupported(baked.format())) {
+		std::cout << "ERROR::TEXTURELOADER::FORMAT_NOT_SUPPORTED " << blockFormatName(baked.format()) << " " << image.path << std::endl;
+		return 0;
+	}
+	GLenum format = BakedTexture::glFormat(baked.format());
+	const std::vector<BakedLevel>& levels = baked.levels();
+	size_t bytes = 0;
+	for (const BakedLevel& level : levels)
+		bytes += level.size;
+	//the blocks go to the driver straight out of the mapping, nothing on the unpack binding
+	glstate.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (glext.directStateAccess) {
+		glext.TextureStorage2D(image.texture, (GLsizei)levels.size(), format, baked.width(), baked.height());
+		for (size_t level = 0; level < levels.size(); level++)
+			glext.CompressedTextureSubImage2D(image.texture, (GLint)level, 0, 0, levels[level].width, levels[level].height,
+				format, (GLsizei)levels[level].size, levels[level].data);
+		return bytes;
+	}
+	glstate.bindTextureForEdit(GL_TEXTURE_2D, image.texture);
+	for (size_t level = 0; level < levels.size(); level++)
+		glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, format, levels[level].width, levels[level].height, 0,
+			(GLsizei)levels[level].size, levels[level].data);
+	//a chain baked short of 1x1 is still complete
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+	return bytes;
+}
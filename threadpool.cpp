@@ -0,0 +1,110 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+	if (threads == 0) {
+		unsigned int hardware = std::thread::hardware_concurrency();
+		threads = hardware > 1 ? hardware - 1 : 1;
+	}
+	for (unsigned int i = 0; i < threads; i++)
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobReady.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	jobsDone.wait(lock, [this] { return jobs.empty() && running == 0; });
+}
+
+void ThreadPool::workerLoop()
+{
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (jobs.empty())
+				return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			running++;
+		}
+		job();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running--;
+			if (jobs.empty() && running == 0)
+				jobsDone.notify_all();
+		}
+	}
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+	if (count == 0)
+		return;
+	grain = std::max<size_t>(grain, 1);
+	size_t chunks = (count + grain - 1) / grain;
+	if (chunks == 1 || workers.empty()) {
+		fn(0, count);
+		return;
+	}
+
+	//chunks are handed out through a shared counter so fast threads take more of them, the counters
+	//live on the heap so a helper that only gets dequeued after the caller returned finds nothing left
+	//(& never touches fn), the caller waits for the chunks, not for the helpers to get a turn
+	struct Shared
+	{
+		std::atomic<size_t> nextChunk{ 0 };
+		std::atomic<size_t> chunksLeft{ 0 };
+		std::mutex doneMutex;
+		std::condition_variable done;
+	};
+	std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+	shared->chunksLeft = chunks;
+	const std::function<void(size_t, size_t)>* body = &fn;
+	auto work = [shared, body, chunks, grain, count] {
+		for (size_t chunk = shared->nextChunk++; chunk < chunks; chunk = shared->nextChunk++) {
+			size_t begin = chunk * grain;
+			(*body)(begin, std::min(begin + grain, count));
+			if (--shared->chunksLeft == 0) {
+				std::lock_guard<std::mutex> lock(shared->doneMutex);
+				shared->done.notify_one();
+			}
+		}
+	};
+
+	size_t helpers = std::min<size_t>(workers.size(), chunks - 1);
+	for (size_t i = 0; i < helpers; i++)
+		submit(work);
+	work();
+
+	//whatever's left is in flight on threads already running it, so this can't wait on a queued job
+	//(& a parallelFor from inside a pool job can't deadlock)
+	std::unique_lock<std::mutex> lock(shared->doneMutex);
+	shared->done.wait(lock, [&] { return shared->chunksLeft == 0; });
+}
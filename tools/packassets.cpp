@@ -0,0 +1,90 @@
+//packs the files the window reads at startup into one asset pack (see assetpack.h), which it maps with --pack
+//run from the repo root:  ./bin/packassets [--out assets.pack] [--no-compress] [files or folders...]
+//with nothing given shaders/ & assets/ are packed (a baked texture only when it's newer than its image)
+#include <assetpack.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+//assets/baked/<name>.btex older than assets/<name>.png, the window wouldn't use it either
+static bool staleBake(const std::filesystem::path& file)
+{
+	if (file.extension() != ".btex" || file.parent_path().filename() != "baked")
+		return false;
+	std::filesystem::path source = file.parent_path().parent_path() / file.filename().replace_extension(".png");
+	std::error_code error;
+	auto sourceTime = std::filesystem::last_write_time(source, error);
+	return !error && std::filesystem::last_write_time(file) < sourceTime;
+}
+
+static void gather(const std::filesystem::path& path, std::vector<std::string>& files)
+{
+	if (std::filesystem::is_directory(path)) {
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+			if (entry.is_regular_file() && !staleBake(entry.path()))
+				files.push_back(entry.path().lexically_normal().generic_string());
+	}
+	else {
+		files.push_back(path.lexically_normal().generic_string());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string out = "assets.pack";
+	bool compress = true;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-compress") == 0) {
+			compress = false;
+		}
+		else {
+			gather(argv[i], files);
+		}
+	}
+	if (files.empty()) {
+		for (const char* folder : { "shaders", "assets" })
+			gather(folder, files);
+	}
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<AssetPackInput> inputs;
+	size_t rawBytes = 0;
+	for (const std::string& path : files) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			std::cout << "Failed to read " << path << std::endl;
+			return -1;
+		}
+		AssetPackInput input;
+		input.name = path;
+		input.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		//the writer only keeps it compressed when that's worth it, so pngs & baked blocks stay as they are
+		input.compress = compress;
+		rawBytes += input.data.size();
+		inputs.push_back(std::move(input));
+	}
+	if (!writeAssetPack(out, inputs))
+		return -1;
+
+	AssetPack pack;
+	if (!pack.open(out, "."))
+		return -1;
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << out << ": " << pack.count() << " files, " << rawBytes / 1024 << " KiB in, "
+		<< std::filesystem::file_size(out) / 1024 << " KiB packed (4 KiB aligned), " << ms << " ms" << std::endl;
+	return 0;
+}
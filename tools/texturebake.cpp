@@ -0,0 +1,143 @@
+//bakes images into block compressed textures with their whole mip chain, which the window maps & uploads as is
+//run from the repo root:  ./bin/texturebake [--format bc1|bc3|bc7] [--filter box|kaiser] [--linear] [--out dir] [--no-flip] [--threads N] [images...]
+//with no images every png in assets/ is baked into assets/baked/ (the scene picks those up when they're newer)
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <bakedtexture.h>
+#include <bcencoder.h>
+#include <mipgen.h>
+#include <threadpool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static bool bake(const std::string& source, const std::string& destination, BlockFormat format, const MipOptions& mipOptions, bool flip, ThreadPool& pool)
+{
+	auto start = std::chrono::steady_clock::now();
+	stbi_set_flip_vertically_on_load(flip);
+	int width, height, channels;
+	unsigned char* decoded = stbi_load(source.c_str(), &width, &height, &channels, 4);
+	if (!decoded) {
+		std::cout << "Failed to load texture " << source << std::endl;
+		return false;
+	}
+	std::vector<MipLevel> mips(1);
+	mips[0].width = width;
+	mips[0].height = height;
+	mips[0].pixels.assign(decoded, decoded + (size_t)width * height * 4);
+	stbi_image_free(decoded);
+
+	//every level down to 1x1 filtered from the full image, then each compressed with its block rows spread over the pool
+	std::vector<MipLevel> chain;
+	generateMips(mips[0].pixels.data(), width, height, mipOptions, chain, &pool);
+	for (MipLevel& level : chain)
+		mips.push_back(std::move(level));
+	std::vector<std::vector<unsigned char>> blocks;
+	std::vector<BakedLevel> levels;
+	for (const MipLevel& mip : mips) {
+		BakedLevel level;
+		level.width = mip.width;
+		level.height = mip.height;
+		level.size = compressedSize(format, mip.width, mip.height);
+		blocks.emplace_back(level.size);
+		compressImage(format, mip.pixels.data(), mip.width, mip.height, blocks.back().data(), &pool);
+		level.data = blocks.back().data();
+		levels.push_back(level);
+	}
+
+	if (!writeBakedTexture(destination, format, flip ? BAKED_FLIPPED : 0, levels))
+		return false;
+
+	size_t bakedBytes = 0;
+	for (const BakedLevel& level : levels)
+		bakedBytes += level.size;
+	//what glGenerateMipmap'd rgba8 would take, the chain is about a third on top of the image
+	size_t rawBytes = (size_t)width * height * 4 * 4 / 3;
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << source << " -> " << destination << ": " << width << "x" << height << " " << blockFormatName(format)
+		<< ", " << levels.size() << " " << mipFilterName(mipOptions.filter) << " levels, " << bakedBytes / 1024 << " KiB (rgba8 " << rawBytes / 1024 << " KiB, "
+		<< (double)rawBytes / bakedBytes << "x smaller), " << ms << " ms" << std::endl;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BlockFormat format = BLOCK_BC7;
+	MipOptions mipOptions;
+	std::string outDir;
+	bool flip = true;
+	unsigned int threads = 0;
+	std::vector<std::string> sources;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			int found = -1;
+			for (int f = 0; f < BLOCK_FORMAT_COUNT; f++)
+				if (strcmp(name, blockFormatName((BlockFormat)f)) == 0)
+					found = f;
+			if (found < 0) {
+				std::cout << "unknown format " << name << " (bc1, bc3 or bc7)" << std::endl;
+				return -1;
+			}
+			format = (BlockFormat)found;
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			int found = -1;
+			for (int f = 0; f < MIP_FILTER_COUNT; f++)
+				if (strcmp(name, mipFilterName((MipFilter)f)) == 0)
+					found = f;
+			if (found < 0) {
+				std::cout << "unknown filter " << name << " (box or kaiser)" << std::endl;
+				return -1;
+			}
+			mipOptions.filter = (MipFilter)found;
+		}
+		else if (strcmp(argv[i], "--linear") == 0) {
+			//the images are data (normal maps, masks) rather than colour, filter the values as they are
+			mipOptions.srgb = false;
+		}
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			outDir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-flip") == 0) {
+			flip = false;
+		}
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = (unsigned int)atoi(argv[++i]);
+		}
+		else {
+			sources.push_back(argv[i]);
+		}
+	}
+
+	if (sources.empty()) {
+		for (const auto& entry : std::filesystem::directory_iterator("assets"))
+			if (entry.is_regular_file() && entry.path().extension() == ".png")
+				sources.push_back(entry.path().string());
+		std::sort(sources.begin(), sources.end());
+		if (outDir.empty())
+			outDir = "assets/baked";
+	}
+
+	ThreadPool pool(threads);
+	std::cout << sources.size() << " images, " << pool.threadCount() + 1 << " threads" << std::endl;
+	int failed = 0;
+	for (const std::string& source : sources) {
+		std::filesystem::path destination = std::filesystem::path(source).replace_extension(".btex");
+		if (!outDir.empty()) {
+			std::filesystem::create_directories(outDir);
+			destination = std::filesystem::path(outDir) / destination.filename();
+		}
+		if (!bake(source, destination.string(), format, mipOptions, flip, pool))
+			failed++;
+	}
+	return failed ? -1 : 0;
+}
@@ -0,0 +1,216 @@
+#include "transforms.h"
+#include "threadpool.h"
+#include "simd.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+
+size_t TransformSystem::add(const glm::vec3& position, const glm::vec3& baseAxis, float baseAngle, const glm::vec3& spinAxis, float spinSpeed_)
+{
+	posX.push_back(position.x);
+	posY.push_back(position.y);
+	posZ.push_back(position.z);
+
+	//the base rotation never changes so it's baked once here
+	glm::mat4 base = glm::rotate(glm::mat4(1.0f), baseAngle, baseAxis);
+	b00.push_back(base[0][0]); b01.push_back(base[0][1]); b02.push_back(base[0][2]);
+	b10.push_back(base[1][0]); b11.push_back(base[1][1]); b12.push_back(base[1][2]);
+	b20.push_back(base[2][0]); b21.push_back(base[2][1]); b22.push_back(base[2][2]);
+
+	glm::vec3 axis = glm::normalize(spinAxis);
+	spinX.push_back(axis.x);
+	spinY.push_back(axis.y);
+	spinZ.push_back(axis.z);
+	spinSpeed.push_back(spinSpeed_);
+	return posX.size() - 1;
+}
+
+void TransformSystem::reserve(size_t count)
+{
+	for (std::vector<float>* array : { &posX, &posY, &posZ, &b00, &b01, &b02, &b10, &b11, &b12, &b20, &b21, &b22, &spinX, &spinY, &spinZ, &spinSpeed })
+		array->reserve(count);
+}
+
+void TransformSystem::clear()
+{
+	for (std::vector<float>* array : { &posX, &posY, &posZ, &b00, &b01, &b02, &b10, &b11, &b12, &b20, &b21, &b22, &spinX, &spinY, &spinZ, &spinSpeed })
+		array->clear();
+}
+
+void TransformSystem::computeModels(float time, float* out, ThreadPool* pool) const
+{
+	if (pool == nullptr) {
+		computeRange(time, 0, size(), out);
+		return;
+	}
+	//chunks are a multiple of the simd width & big enough to not drown in scheduling
+	pool->parallelFor(size(), 16384, [&](size_t begin, size_t end) {
+		computeRange(time, begin, end, out);
+	});
+}
+
+void TransformSystem::computeIndexed(float time, const uint32_t* indices, size_t count, float* out, ThreadPool* pool) const
+{
+	if (pool == nullptr) {
+		computeIndexedRange(time, indices, 0, count, out);
+		return;
+	}
+	pool->parallelFor(count, 16384, [&](size_t begin, size_t end) {
+		computeIndexedRange(time, indices, begin, end, out);
+	});
+}
+
+void TransformSystem::computeRangeScalar(float time, size_t begin, size_t end, float* out) const
+{
+	for (size_t i = begin; i < end; i++)
+		computeOneScalar(time, i, out + i * 16);
+}
+
+void TransformSystem::computeOneScalar(float time, size_t i, float* model) const
+{
+	//spin rotation, same terms as glm::rotate
+	float angle = time * spinSpeed[i];
+	float c = std::cos(angle);
+	float s = std::sin(angle);
+	float ax = spinX[i], ay = spinY[i], az = spinZ[i];
+	float tx = (1.0f - c) * ax, ty = (1.0f - c) * ay, tz = (1.0f - c) * az;
+	float spin[3][3] = {
+		{ c + tx * ax, tx * ay + s * az, tx * az - s * ay },
+		{ ty * ax - s * az, c + ty * ay, ty * az + s * ax },
+		{ tz * ax + s * ay, tz * ay - s * ax, c + tz * az }
+	};
+	float base[3][3] = {
+		{ b00[i], b01[i], b02[i] },
+		{ b10[i], b11[i], b12[i] },
+		{ b20[i], b21[i], b22[i] }
+	};
+
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++)
+			model[column * 4 + row] = base[0][row] * spin[column][0] + base[1][row] * spin[column][1] + base[2][row] * spin[column][2];
+		model[column * 4 + 3] = 0.0f;
+	}
+	model[12] = posX[i];
+	model[13] = posY[i];
+	model[14] = posZ[i];
+	model[15] = 1.0f;
+}
+
+
+#ifdef SIMD_AVAILABLE
+
+using namespace simd;
+
+namespace {
+
+//turns one column of simd::width matrices (x, y, z, w lanes) into width vec4 stores
+inline void storeColumn(float* out, int column, vfloat x, vfloat y, vfloat z, vfloat w, bool stream)
+{
+	for (int h = 0; h < width / 4; h++) {
+		__m128 a = half(x, h), b = half(y, h), c = half(z, h), d = half(w, h);
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		float* base = out + (h * 4) * 16 + column * 4;
+		if (stream) {
+			//the instance buffer is write only, don't pull it through the cache
+			_mm_stream_ps(base, a);
+			_mm_stream_ps(base + 16, b);
+			_mm_stream_ps(base + 32, c);
+			_mm_stream_ps(base + 48, d);
+		}
+		else {
+			_mm_storeu_ps(base, a);
+			_mm_storeu_ps(base + 16, b);
+			_mm_storeu_ps(base + 32, c);
+			_mm_storeu_ps(base + 48, d);
+		}
+	}
+}
+
+}
+
+//width objects' matrices, load(array) fetches the lanes (contiguous or gathered)
+template <typename Load>
+inline void TransformSystem::computeBlock(float time, Load load, float* model, bool stream) const
+{
+	vfloat one = vset(1.0f);
+	vfloat zero = vset(0.0f);
+
+	vfloat s, c;
+	vsincos(vmul(vset(time), load(spinSpeed)), s, c);
+	vfloat ax = load(spinX), ay = load(spinY), az = load(spinZ);
+	vfloat t = vsub(one, c);
+	vfloat tx = vmul(t, ax), ty = vmul(t, ay), tz = vmul(t, az);
+
+	//spin rotation, same terms as glm::rotate
+	vfloat s00 = vadd(c, vmul(tx, ax)), s01 = vadd(vmul(tx, ay), vmul(s, az)), s02 = vsub(vmul(tx, az), vmul(s, ay));
+	vfloat s10 = vsub(vmul(ty, ax), vmul(s, az)), s11 = vadd(c, vmul(ty, ay)), s12 = vadd(vmul(ty, az), vmul(s, ax));
+	vfloat s20 = vadd(vmul(tz, ax), vmul(s, ay)), s21 = vsub(vmul(tz, ay), vmul(s, ax)), s22 = vadd(c, vmul(tz, az));
+
+	vfloat base0[3] = { load(b00), load(b01), load(b02) };
+	vfloat base1[3] = { load(b10), load(b11), load(b12) };
+	vfloat base2[3] = { load(b20), load(b21), load(b22) };
+	vfloat spin[3][3] = { { s00, s01, s02 }, { s10, s11, s12 }, { s20, s21, s22 } };
+
+	for (int column = 0; column < 3; column++) {
+		vfloat rows[3];
+		for (int row = 0; row < 3; row++)
+			rows[row] = vadd(vadd(vmul(base0[row], spin[column][0]), vmul(base1[row], spin[column][1])), vmul(base2[row], spin[column][2]));
+		storeColumn(model, column, rows[0], rows[1], rows[2], zero, stream);
+	}
+	storeColumn(model, 3, load(posX), load(posY), load(posZ), one, stream);
+}
+
+void TransformSystem::computeRange(float time, size_t begin, size_t end, float* out) const
+{
+	bool stream = ((uintptr_t)out & 15) == 0;
+	size_t i = begin;
+	for (; i + width <= end; i += width)
+		computeBlock(time, [i](const std::vector<float>& array) { return vload(&array[i]); }, out + i * 16, stream);
+	if (stream)
+		_mm_sfence();
+
+	//leftovers that don't fill a whole register
+	computeRangeScalar(time, i, end, out);
+}
+
+void TransformSystem::computeIndexedRange(float time, const uint32_t* indices, size_t begin, size_t end, float* out) const
+{
+	bool stream = ((uintptr_t)out & 15) == 0;
+	size_t i = begin;
+	for (; i + width <= end; i += width) {
+		const uint32_t* lanes = indices + i;
+		computeBlock(time, [lanes](const std::vector<float>& array) { return vgather(array.data(), lanes); }, out + i * 16, stream);
+	}
+	if (stream)
+		_mm_sfence();
+	for (; i < end; i++)
+		computeOneScalar(time, indices[i], out + i * 16);
+}
+
+int TransformSystem::simdWidth()
+{
+	return width;
+}
+
+#else
+
+void TransformSystem::computeRange(float time, size_t begin, size_t end, float* out) const
+{
+	computeRangeScalar(time, begin, end, out);
+}
+
+void TransformSystem::computeIndexedRange(float time, const uint32_t* indices, size_t begin, size_t end, float* out) const
+{
+	for (size_t i = begin; i < end; i++)
+		computeOneScalar(time, indices[i], out + i * 16);
+}
+
+int TransformSystem::simdWidth()
+{
+	return 1;
+}
+
+#endif